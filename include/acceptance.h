@@ -0,0 +1,58 @@
+#pragma once
+#include <random>
+#include <vector>
+
+// Move acceptance for ALNS. All criteria are scaled by the routing cost of the
+// initial solution (score without the unrouted penalty), so the same settings
+// behave alike on a 10-employee and a 1000-employee instance, and all follow
+// the run's progress (the larger of iterations used and wall time used, 0..1)
+// rather than a per-iteration factor, so a short budget still ends greedy.
+
+enum AcceptanceKind {
+    ACCEPT_SA,           // simulated annealing
+    ACCEPT_RRT,          // record-to-record travel: within a deviation of the best
+    ACCEPT_THRESHOLD,    // threshold accepting: worsening below a threshold
+    ACCEPT_LAHC          // late-acceptance hill climbing
+};
+
+struct AcceptanceConfig {
+    AcceptanceKind kind = ACCEPT_SA;
+
+    // SA: T0 is set so that a move start_worsening (share of the initial cost)
+    // worse is accepted with probability start_accept, and T falls
+    // geometrically to T0 * end_temperature over the budget. With
+    // calibrate = false, ALNSConfig::T0 / cooling apply per iteration instead.
+    bool calibrate = true;
+    double start_worsening = 0.002;
+    double start_accept = 0.5;
+    double end_temperature = 0.01;
+
+    // RRT deviation and TA threshold start at start_worsening of the initial
+    // cost and shrink linearly to 0.
+
+    int lahc_length = 50;      // LAHC: history length (iterations of lateness)
+};
+
+class Acceptance {
+public:
+    // T0 / cooling are ALNSConfig's fixed schedule (uncalibrated SA only).
+    Acceptance(const AcceptanceConfig& cfg, double T0, double cooling,
+               double initial_score, double initial_cost);
+
+    // Decides whether to move to `candidate` from `current`; `best` is the best
+    // score so far. Call once per iteration, in order.
+    bool accept(double candidate, double current, double best, double progress,
+                std::mt19937& rng);
+
+    // Temperature, deviation or threshold in effect (LAHC: oldest history value).
+    double level() const { return level_; }
+    const char* name() const;
+
+private:
+    AcceptanceConfig cfg_;
+    double scale_;             // initial routing cost, >= 1
+    double T0_, cooling_;
+    double level_;
+    std::vector<double> history_;
+    size_t step_ = 0;
+};
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+
+// Number of global operator new calls made by the calling thread so far,
+// plus those credited to it. alloc_counter.cpp replaces the global allocation
+// functions to count them; run_alns() reports the per-iteration figure to show
+// the search loop does not allocate once warmed up.
+uint64_t heap_allocations();
+
+// Adds `n` allocations made on its behalf by other threads (TaskPool workers
+// credit their share of a parallel_for to the thread that called it).
+void credit_heap_allocations(uint64_t n);
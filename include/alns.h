@@ -1,6 +1,22 @@
 #pragma once
+#include <cstddef>
 #include <vector>
 #include "types.h"
+#include "acceptance.h"
+
+enum ALNSMode {
+    ALNS_ADAPTIVE,   // adaptive pool of destroy/repair operators
+    ALNS_SISR        // slack induction by string removals (Christiaens & Vanden Berghe)
+};
+
+// SISR ruin & recreate parameters; defaults follow the paper.
+struct SISRConfig {
+    double avg_removed = 10.0;     // c-bar: average number of employees removed
+    int max_string_len = 10;       // L-max: cap on string length per trip
+    double split_rate = 0.5;       // chance of a split string instead of a plain one
+    double split_depth = 0.01;     // alpha: chance to grow the preserved part of a split
+    double blink_rate = 0.01;      // beta: chance to skip an insertion position
+};
 
 // Config is intentionally simple (hackathon friendly).
 struct ALNSConfig {
@@ -9,18 +25,52 @@ struct ALNSConfig {
     int max_remove = 12;           // max employees removed in ruin
     int no_improve_stop = 400;     // stop early if no improvement
 
-    // Simulated annealing acceptance
-    double T0 = 500.0;             // initial temperature (scaled later if you want)
+    // Fixed simulated annealing schedule; only used when accept.calibrate is off.
+    double T0 = 500.0;             // initial temperature
     double cooling = 0.999;        // T *= cooling
 
     // Repair style
     bool use_regret2 = true;       // regret-2 insertion vs greedy
     bool apply_two_opt_after_repair = false;
+
+    // Adaptive operator weights (Ropke & Pisinger): scores are summed over a
+    // segment of iterations, then blended into the weights.
+    int segment_length = 100;      // iterations per weight update
+    double reaction = 0.1;         // how fast weights follow the segment reward
+    double sigma1 = 33.0;          // score: new global best
+    double sigma2 = 9.0;           // score: better than current
+    double sigma3 = 13.0;          // score: worse but accepted
+    bool time_normalized = true;   // divide reward by relative time per use
+    double min_weight = 0.05;      // keeps every operator selectable
+
+    // Worst removal draws rank floor(y^p * n); higher p = greedier.
+    double worst_randomness = 3.0;
+    // Time-band removal takes employees whose due_time is within this many
+    // minutes of a random seed's due_time.
+    int time_band_min = 30;
+
+    double time_limit_sec = 0.0;   // 0 = no wall-time limit
+    bool resequence = true;        // exact pickup order for every trip a repair touched
+
+    // Solution fingerprints (zobrist.h): a repair that rebuilds an already
+    // visited solution is rejected outright, or, with revisit_penalty > 0,
+    // goes through acceptance with the penalty added to its score.
+    bool tabu = true;
+    size_t tabu_capacity = 1 << 16;   // fingerprints remembered (older ones are evicted)
+    double revisit_penalty = 0.0;
+
+    ALNSMode mode = ALNS_ADAPTIVE;
+    SISRConfig sisr;
+    AcceptanceConfig accept;       // acceptance criterion (acceptance.h)
 };
 
+class TripPool;
+
 // Runs ALNS starting from the current solution already stored in vehicles/routes.
 // employees vector will be updated (is_routed etc.) as your solver already does.
+// When `pool` is given, every trip the repair step produces is added to it.
 void run_alns(std::vector<Employee>& employees,
               std::vector<Vehicle>& vehicles,
               const ALNSConfig& cfg,
-              bool debug);
+              bool debug,
+              TripPool* pool = nullptr);
@@ -0,0 +1,191 @@
+#pragma once
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include "types.h"
+#include "alns.h"
+#include "objective.h"
+#include "route_eval.h"
+#include "instance_store.h"
+#include "arena.h"
+#include "spatial_index.h"
+
+// ------------------------------------------------------------
+// ALNS operator registry
+// ------------------------------------------------------------
+//
+// Destroy and repair operators are named objects with their own statistics and
+// adaptive weight. run_alns() only talks to the registry, so adding an operator
+// means writing the function and registering it in register_default_operators().
+
+// Static neighbourhoods over the instance, built once per run. Indices are
+// Employee::index (the instance vector and InstanceStore in ALNSContext).
+struct NeighbourIndex {
+    SpatialGrid grid;              // pickup locations of store.members
+    std::vector<int> grid_ids;     // grid point -> Employee::index
+    std::vector<int> by_due;       // employees sorted by due_time
+};
+
+NeighbourIndex build_neighbour_index(const InstanceStore& store);
+
+// Read-only state shared by all operators during one ALNS run.
+struct ALNSContext {
+    const EmployeeIndex& idx;
+    const ObjectiveWeights& w;
+    std::mt19937& rng;
+    const std::vector<Employee>& instance;
+    const InstanceStore& store;
+    const NeighbourIndex& nb;
+    const ALNSConfig& cfg;
+};
+
+// Picks up to q routed employees to remove (does not modify the solution),
+// as Employee::index values in iteration-arena memory.
+using DestroyFn = std::function<ScratchVec<int>(
+    const ALNSContext& ctx, const SolutionState& state, const std::vector<Vehicle>& vehicles, int q)>;
+
+// Re-inserts `removed` into the solution, keeping `obj` in sync.
+using RepairFn = std::function<void(
+    const ALNSContext& ctx, SolutionState& state, std::vector<Vehicle>& vehicles,
+    ScratchVec<int>& removed, SolutionObjective& obj)>;
+
+struct OperatorStats {
+    int uses = 0;
+    int accepted = 0;
+    int improved = 0;        // better than the current solution
+    int new_best = 0;
+    double seconds = 0.0;
+};
+
+struct ALNSOperator {
+    std::string name;
+    double weight = 1.0;
+
+    // Accumulated over the current segment, reset by end_segment().
+    double segment_score = 0.0;
+    double segment_seconds = 0.0;
+    int segment_uses = 0;
+
+    OperatorStats total;
+};
+
+struct DestroyOperator : ALNSOperator { DestroyFn fn; };
+struct RepairOperator : ALNSOperator { RepairFn fn; };
+
+// Outcome of one iteration, scored Ropke–Pisinger style (sigma1/2/3 in ALNSConfig).
+enum class IterationOutcome { REJECTED, ACCEPTED, IMPROVED, NEW_BEST };
+
+struct OperatorRegistry {
+    std::vector<DestroyOperator> destroy;
+    std::vector<RepairOperator> repair;
+
+    void add_destroy(const std::string& name, DestroyFn fn);
+    void add_repair(const std::string& name, RepairFn fn);
+
+    int pick_destroy(std::mt19937& rng) const;
+    int pick_repair(std::mt19937& rng) const;
+
+    // Credits both operators used in an iteration.
+    void record(int d, int r, IterationOutcome outcome, double destroy_sec, double repair_sec,
+                const ALNSConfig& cfg);
+
+    // Segment-based weight update: w = (1-reaction) w + reaction * reward, where the
+    // reward is the mean score per use, divided by the operator's time per use relative
+    // to the average of the operators used in the segment (when time_normalized).
+    void end_segment(const ALNSConfig& cfg);
+
+    void print_stats() const;
+};
+
+void register_default_operators(OperatorRegistry& reg, const ALNSConfig& cfg);
+
+// ALNS_SISR mode: a single string-removal ruin and blink recreate (cfg.sisr).
+void register_sisr_operators(OperatorRegistry& reg, const ALNSConfig& cfg);
+
+// ------------------------------------------------------------
+// Solution edits shared by operators and the main loop
+// ------------------------------------------------------------
+// Unroutes the listed employees, erasing their stops at the placements recorded
+// in `state`; ids that are not routed are ignored.
+void apply_removals(SolutionState& state,
+                    std::vector<Vehicle>& vehicles,
+                    const ScratchVec<int>& removed,
+                    const EmployeeIndex& idx,
+                    SolutionObjective& obj);
+
+// Cheapest feasible insertion of one employee: trip slot ri of vehicle vi
+// (ri == routes.size() opens a new trailing trip) and the resulting trip.
+// Slots are searched in lower-bound order with early exit; `second` (if given)
+// receives the runner-up delta for regret computations.
+struct InsertionChoice {
+    int vi = -1, ri = -1;
+    Route route;
+    double delta = 0.0;            // objective change incl. pushed later trips
+};
+
+// Batch prices (price_insertions_block()) of the employees a repair still has
+// to place, at every position of every trip, shared by the repair's scans. A
+// trip is flattened once and priced for the whole block the first time a scan
+// reaches it; placing an employee drops its column and re-lays out the trips of
+// the vehicle that changed. Memory comes from the caller's arena scope.
+// row() may run concurrently; construction and placed() may not.
+struct InsertionPrices {
+    InsertionPrices(const std::vector<Vehicle>& vehicles, const SolutionState& state,
+                    const InstanceStore& store, const ScratchVec<int>& emps, const ObjectiveWeights& w);
+
+    // Column of the employee in the block, -1 if it is not (or no longer) in it.
+    int column(int emp_index) const;
+    // Prices of column `col` at stops 0..n-1 of trip ri of vehicle vi, or null
+    // when the trip is not covered (a trip opened after the last layout).
+    const double* row(int vi, int ri, int col);
+    // After an insertion of the employee was committed to vehicle vi.
+    void placed(int emp_index, int vi);
+
+private:
+    struct Trip;
+    void layout(int vi);
+
+    const std::vector<Vehicle>& vehicles_;
+    const SolutionState& state_;
+    const ObjectiveWeights& w_;
+    ScratchVec<const Employee*> emps_;   // null once placed
+    ScratchVec<Trip*> trips_;            // per vehicle, routes.size() at its last layout
+    ScratchVec<int> count_;
+};
+
+bool find_best_insertion(const std::vector<Vehicle>& vehicles,
+                         const Employee& emp,
+                         const EmployeeIndex& idx,
+                         const ObjectiveWeights& w,
+                         InsertionChoice& best,
+                         double blink_rate = 0.0,
+                         std::mt19937* rng = nullptr,
+                         double* second = nullptr,
+                         const SolutionState* state = nullptr,
+                         InsertionPrices* prices = nullptr);
+
+// Applies a choice from find_best_insertion(), re-chaining later trips.
+void commit_insertion(std::vector<Vehicle>& vehicles, InsertionChoice&& choice,
+                      const EmployeeIndex& idx, SolutionObjective& obj);
+
+// Cheapest feasible insertion over all trips (including a new trailing trip).
+// blink_rate > 0 skips each candidate position with that probability.
+bool try_insert_anywhere(SolutionState& state,
+                         std::vector<Vehicle>& vehicles,
+                         const Employee& emp,
+                         const EmployeeIndex& idx,
+                         const ObjectiveWeights& w,
+                         SolutionObjective& obj,
+                         double blink_rate = 0.0,
+                         std::mt19937* rng = nullptr,
+                         InsertionPrices* prices = nullptr);
+
+// Rebuilds the removal-gain cache of every route marked stale (i.e. changed since
+// its last refresh); untouched routes keep their cached gains. Returns the number
+// of routes re-priced. Call on the current solution after each accepted move.
+int refresh_removal_gains(std::vector<Vehicle>& vehicles, const EmployeeIndex& idx,
+                          const ObjectiveWeights& w);
+
+// Optional route-level polish after repair.
+void two_opt_vehicle(Vehicle& vehicle, bool debug);
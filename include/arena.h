@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// Monotonic scratch memory for search iterations.
+//
+// Operators take their temporary vectors from the calling thread's arena
+// (ScratchVec + iteration_arena()); nothing is freed individually. An
+// ArenaScope rewinds the arena to where it was when the scope opened, so
+// run_alns() opens one per iteration and helpers used outside ALNS open their
+// own. Blocks are kept across rewinds, so once the arena has grown to the
+// largest iteration seen, scratch allocations never reach the heap.
+class IterationArena : public std::pmr::memory_resource {
+public:
+    explicit IterationArena(size_t block_bytes = 64 * 1024);
+    ~IterationArena() override;
+    IterationArena(const IterationArena&) = delete;
+    IterationArena& operator=(const IterationArena&) = delete;
+
+    struct Mark { size_t block; size_t offset; };
+    Mark mark() const { return {cur_, off_}; }
+    void rewind(Mark m) { cur_ = m.block; off_ = m.offset; }
+
+    size_t reserved_bytes() const;     // total block capacity held
+    size_t high_water() const { return high_water_; }
+
+private:
+    void* do_allocate(size_t bytes, size_t align) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override { return this == &o; }
+
+    struct Block { char* data; size_t size; };
+    std::vector<Block> blocks_;
+    size_t block_bytes_;
+    size_t cur_ = 0;                   // block being filled
+    size_t off_ = 0;                   // bytes used in blocks_[cur_]
+    size_t high_water_ = 0;            // most bytes live at once (summed over blocks)
+};
+
+// The calling thread's arena.
+IterationArena& iteration_arena();
+
+// Rewinds the arena on scope exit; every ScratchVec made inside must die first.
+class ArenaScope {
+public:
+    explicit ArenaScope(IterationArena& a = iteration_arena()) : arena_(a), mark_(a.mark()) {}
+    ~ArenaScope() { arena_.rewind(mark_); }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    IterationArena& arena_;
+    IterationArena::Mark mark_;
+};
+
+template <class T>
+using ScratchVec = std::pmr::vector<T>;
+
+template <class T>
+ScratchVec<T> scratch_vec(size_t n = 0) {
+    return ScratchVec<T>(n, &iteration_arena());
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "types.h"
+
+// Precomputed "can these two employees ever share a trip" relation, plus
+// per-vehicle-category eligibility, as bitsets over Employee::index.
+// Built once at load time so insertion can reject a whole trip with one bit
+// test against the AND of its passengers' rows (SolutionState::trip_mask)
+// before any timeline work.
+//
+// Two employees are compatible if, for some pickup order, leaving the first
+// pickup at its ready_time and driving at the fleet's top speed reaches the
+// office within both hard deadlines, and some vehicle with >= 2 seats may
+// carry both. The test is optimistic, so it never rejects a feasible trip.
+struct CompatBits {
+    int n = 0;
+    int words = 0;
+    std::vector<uint64_t> pair;               // n rows of `words` words
+    std::vector<uint64_t> eligible[3];        // indexed by VehicleCat
+
+    const uint64_t* row(int i) const { return pair.data() + (size_t)i * words; }
+};
+
+extern CompatBits g_compat;
+
+template <class Bits>
+inline bool bit_test(const Bits& bits, int i) {
+    return (bits[(size_t)i >> 6] >> (i & 63)) & 1u;
+}
+
+void build_compat(const std::vector<Employee>& emps, const std::vector<Vehicle>& vehs);
+
+// True if `e` may ride a vehicle of category `cat` (always true before build_compat).
+bool compat_eligible(VehicleCat cat, const Employee& e);
+
+// AND of the rows of the passengers in `stops` into `mask` (g_compat.words
+// words; all ones for a trip without passengers).
+void build_trip_compat(const StopList& stops, uint64_t* mask);
+
+// True if `e` is compatible with every passenger in `stops` (always true
+// before build_compat): one bit test per pickup, for trips without a mask.
+bool compat_with_trip(const StopList& stops, const Employee& e);
@@ -8,6 +8,26 @@ extern double ALPHA2;
 extern double LAMBDA;
 extern double MU;
 
+// Instance metadata (metadata[] in the input JSON).
+// PRIORITY_MAX_DELAY[p] = minutes a priority-p employee may arrive after latest_drop.
+// Index 0 is unused; all zero means hard time windows.
+extern int PRIORITY_MAX_DELAY[6];
+extern double OBJ_COST_WEIGHT;
+extern double OBJ_TIME_WEIGHT;
+// Rs per passenger-minute, derived from the baseline (sum cost / sum time)
+// so time and cost terms live on the same scale.
+extern double TIME_VALUE_PER_MIN;
+// Base Rs per late passenger-minute. Set by --late-rate=RS, else by metadata
+// "lateness_penalty_per_min", else TIME_VALUE_PER_MIN: a late minute costs what
+// the baseline pays for a minute of someone's time. Negative until resolved
+// by load_from_json().
+extern double LATENESS_PENALTY_PER_MIN;
+// PRIORITY_LATE_WEIGHT[p] multiplies the base rate for a priority-p passenger.
+// Default 6 - p: one step per class, so a late minute of priority 1 (most
+// important) weighs as much as five of priority 5. Metadata
+// "priority_<p>_late_weight" overrides a class. Index 0 is unused.
+extern double PRIORITY_LATE_WEIGHT[6];
+
 extern const double INF;
 extern const double PI;
 
@@ -0,0 +1,62 @@
+#pragma once
+#include <vector>
+#include "types.h"
+#include "alns.h"
+
+// Cluster-first decomposition for large instances. Employees are partitioned
+// geographically, each part gets a share of the fleet proportional to the
+// seats it needs, and the parts are solved concurrently with the usual
+// Solomon construction + ALNS. The merged solution then gets a boundary-repair
+// pass: for each pair of neighbouring parts, the vehicles serving the border
+// employees of both (plus anything left unrouted there) are re-optimized
+// together by ALNS.
+
+enum PartitionMethod { PARTITION_SWEEP, PARTITION_KMEANS };
+
+struct DecomposeConfig {
+    int part_size = 0;                 // target employees per part; 0 = decomposition off
+    double overlap = 0.15;             // share of a part's employees nearest a neighbour
+                                       // that the boundary repair re-optimizes
+    PartitionMethod method = PARTITION_SWEEP;
+    int boundary_rounds = 1;           // passes over all neighbouring pairs
+    double boundary_iterations = 0.5;  // boundary ALNS iterations, as a share of the main run
+    unsigned seed = 12345;             // k-means initialisation
+};
+
+// Employee parts as positions in `emps`; every employee is in exactly one part.
+std::vector<std::vector<int>> partition_employees(const std::vector<Employee>& emps,
+                                                  int parts, PartitionMethod method,
+                                                  unsigned seed);
+
+// Builds routes for all employees (vehicles must have no routes yet) by solving
+// the parts independently and repairing their boundaries. Falls back to one
+// part when the instance is not larger than cfg.part_size.
+void solve_decomposed(std::vector<Employee>& employees,
+                      std::vector<Vehicle>& vehicles,
+                      const ALNSConfig& alns_cfg,
+                      const DecomposeConfig& cfg,
+                      bool debug);
+
+// Time-layered solve. Employees are bucketed by office-arrival slot
+// (due_time rounded up to slot_minutes) and the slots are constructed in
+// chronological order, each on the fleet as the earlier slots left it
+// (location and available time). Each slot's trips are then improved by a
+// slot-local ALNS over the vehicles that serve it; slots with disjoint vehicle
+// sets run in parallel. A cross-slot ALNS over the whole plan finishes.
+struct LayerConfig {
+    int slot_minutes = 0;              // slot width; 0 = layering off
+    int min_slot_size = 8;             // smaller slots merge into the next one
+    double slot_iterations = 0.5;      // slot ALNS iterations, as a share of the main run
+    double final_iterations = 0.5;     // cross-slot ALNS iterations, same scale
+};
+
+// Employee slots as positions in `emps`, in chronological order.
+std::vector<std::vector<int>> time_slots(const std::vector<Employee>& emps,
+                                         int slot_minutes, int min_slot_size);
+
+// Builds routes for all employees slot by slot (vehicles must have no routes yet).
+void solve_time_layered(std::vector<Employee>& employees,
+                        std::vector<Vehicle>& vehicles,
+                        const ALNSConfig& alns_cfg,
+                        const LayerConfig& cfg,
+                        bool debug);
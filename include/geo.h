@@ -4,4 +4,4 @@
 
 double get_dist(Location a, Location b);
 int travel_minutes(double dist_km, double speed_kmh);
-double recompute_distance_km(const std::vector<Stop>& stops);
+double recompute_distance_km(const StopList& stops);
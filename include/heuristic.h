@@ -3,8 +3,48 @@
 #include <map>
 #include <string>
 #include "types.h"
+#include "config.h"
 
-std::vector<int> get_sorted_indices_by_tightness(const std::vector<Employee>& emps);
+// Processing order for the constructor ("seed" employees go first).
+enum SeedStrategy { SEED_EARLIEST_DUE, SEED_FARTHEST, SEED_SWEEP };
+
+// Construction knobs; defaults reproduce the global Solomon parameters.
+struct ConstructionParams {
+    double alpha1 = ALPHA1;          // c1 weight on distance detour
+    double alpha2 = ALPHA2;          // c1 weight on service-start push
+    double lambda = LAMBDA;          // c2 weight on distance from trip start
+    double mu = MU;                  // detour discount on the replaced edge
+    bool cost_weighted = true;       // price detours with the vehicle's cost_per_km
+    SeedStrategy seed = SEED_EARLIEST_DUE;
+    bool parallel_routes = true;     // insert into any trip of a vehicle, not just the last one
+    unsigned tie_break_seed = 0;     // 0 = deterministic order; otherwise shuffles equal keys
+};
+
+// Multi-start construction: N perturbed Solomon passes run in parallel on the
+// task pool, each on its own copy of the fleet; the best (objective score) is kept.
+struct MultiStartConfig {
+    int starts = 1;                  // 1 = plain single pass; start 0 always uses the default parameters
+    unsigned seed = 12345;           // drives the parameter perturbation
+};
+
+std::vector<int> get_sorted_indices_by_tightness(const std::vector<Employee>& emps,
+                                                unsigned tie_break_seed = 0);
+std::vector<int> get_seed_order(const std::vector<Employee>& emps, SeedStrategy seed,
+                                unsigned tie_break_seed = 0);
+
+// Builds a solution on top of the vehicles' current state; reasons for
+// employees that could not be placed are written to `unrouted_reason`.
+void construct_solution(std::vector<Employee>& employees,
+                        std::vector<Vehicle>& vehicles,
+                        const ConstructionParams& params,
+                        std::map<std::string, std::string>& unrouted_reason,
+                        bool debug = false);
+
+// Replaces the vehicles' routes with the best of cfg.starts constructions.
+void solve_multistart(std::vector<Employee>& employees,
+                      std::vector<Vehicle>& vehicles,
+                      const MultiStartConfig& cfg,
+                      bool debug = false);
 
 void solve_solomon_insertion(std::vector<Employee>& employees,
                             std::vector<Vehicle>& vehicles,
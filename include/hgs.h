@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+#include "types.h"
+
+// Hybrid genetic search (Vidal et al.): a population of solutions, each one
+// educated by relocate local search, recombined with OX crossover on giant tours
+// and decoded by a split that respects START -> pickups -> END trips and
+// multi-trip chaining. Diversity is managed through broken-pair distance in a
+// biased fitness (cost rank + diversity rank).
+struct HGSConfig {
+    int population = 25;           // mu: survivors kept after selection
+    int generation = 40;           // lambda: offspring added before selection
+    int elite = 4;                 // individuals protected by cost rank in the fitness
+    int close = 5;                 // neighbours averaged for the diversity contribution
+    int iterations = 3000;         // offspring generated
+    int no_improve_stop = 800;     // stop after this many offspring without a new best
+    double time_limit_sec = 0.0;   // 0 = no limit
+    int ls_passes = 2;             // relocate passes per education
+};
+
+// Improves the solution stored in vehicles/employees; the starting solution is
+// seeded into the population, so the result is never worse.
+void run_hgs(std::vector<Employee>& employees,
+             std::vector<Vehicle>& vehicles,
+             const HGSConfig& cfg,
+             bool debug);
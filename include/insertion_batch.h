@@ -0,0 +1,83 @@
+#pragma once
+#include <random>
+#include <vector>
+#include "types.h"
+#include "objective.h"
+#include "route_eval.h"
+
+// Batch pricing of one employee at every position of a trip.
+//
+// The scalar evaluator re-times and re-finalizes a full copy of the trip per
+// position. Here the trip is flattened once into arrays (TripSoA), and the
+// timing of all positions is simulated side by side: each lane is one
+// insertion position and steps through the trip's stops, so the whole pass is
+// integer max/add over lanes (8 at a time with AVX2, one at a time otherwise).
+// Only the detour legs to and from the new pickup cost distance evaluations.
+//
+// Feasibility and all minute totals match simulate_insertion()/finalize_route()
+// exactly; the score differs only by floating-point summation order.
+// best_insert_batch() therefore re-evaluates the few positions within rounding
+// distance of the batch minimum with the scalar evaluator, and returns the same
+// trip as best_insert_scalar().
+
+struct TripSoA {
+    int n = 0;                        // stops, START and END included
+    double speed_kmh = 0.0;
+    double cost_per_km = 0.0;
+    double base_km = 0.0;             // trip distance
+    int passengers = 0;
+    int hard_deadline = 0;            // route.late.hard_deadline
+    const LatenessProfile* late = nullptr;
+    // Per stop j (index 0 = START, n-1 = END):
+    std::vector<int> node;
+    std::vector<int> ready;           // pickups: ready_time; START/END unused
+    std::vector<int> dep;             // departure time
+    std::vector<double> leg_km;       // j >= 1: distance of the leg into j
+    std::vector<int> leg_min;         // j >= 1: its travel minutes
+    std::vector<int> wait_prefix;     // waits at pickups 1..j-1
+    std::vector<int> dep_prefix;      // departures of pickups 1..j-1
+};
+
+// Flattens `route` as run by `v`, reusing Route::leg_km for the legs. The
+// arrays keep their capacity across calls.
+void build_trip_soa(const Route& route, const Vehicle& v, TripSoA& t);
+
+// cost[p] = route_score() of the trip with `emp` inserted before stop p, for
+// p in 1..n-1 (infinity when infeasible or skip[p] is set); cost[0] = infinity.
+// `skip` may be null. `cost` must hold t.n values.
+void price_insertions(const TripSoA& t, const Employee& emp, const ObjectiveWeights& w,
+                      const unsigned char* skip, double* cost);
+
+// The same for a block of employees against one trip: the (employee, position)
+// lanes of all of them go through the timing kernel in one pass over the trip.
+// Row e of `cost` (stride t.n) prices emps[e]; rows of null entries are not
+// written.
+void price_insertions_block(const TripSoA& t, const Employee* const* emps, int m,
+                            const ObjectiveWeights& w, double* cost);
+
+// Best-position insertion of `emp` into `route` (START and END stay fixed);
+// with blink_rate > 0 each position is skipped with that probability (SISR
+// blinks). Returns false and leaves `route` alone when no position is feasible.
+// Both pick the lowest score, earliest position on ties.
+bool best_insert_scalar(Route& route, const Vehicle& vehicle, const Employee& emp,
+                        const EmployeeIndex& idx, const ObjectiveWeights& w,
+                        double blink_rate = 0.0, std::mt19937* rng = nullptr);
+bool best_insert_batch(Route& route, const Vehicle& vehicle, const Employee& emp,
+                       const EmployeeIndex& idx, const ObjectiveWeights& w,
+                       double blink_rate = 0.0, std::mt19937* rng = nullptr);
+// best_insert_batch() from prices already computed for `route` (a row of
+// price_insertions_block()); compatibility is the caller's check.
+bool best_insert_priced(Route& route, const Vehicle& vehicle, const Employee& emp,
+                        const EmployeeIndex& idx, const ObjectiveWeights& w, const double* prices,
+                        double blink_rate = 0.0, std::mt19937* rng = nullptr);
+
+// Vector kernel in use: true when the CPU has AVX2 and it was not turned off.
+bool insertion_simd_enabled();
+void insertion_simd_configure(bool enabled);
+
+// Microbenchmark on the trips of the current solution: per trip length, time
+// of the scalar evaluator vs the batch one (scalar and AVX2 kernels, and the
+// AVX2 kernel over each trip's employees as one block), plus a count of
+// positions where the batch pick differs from the scalar one.
+void bench_insertion(const std::vector<Employee>& employees,
+                     const std::vector<Vehicle>& vehicles);
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "types.h"
+
+// Employee data split by access pattern, indexed by Employee::index.
+//
+// InstanceStore keeps the immutable attributes the operators scan in their
+// inner loops as parallel arrays; cold metadata (id, drop, baselines) stays in
+// the Employee records. SolutionState is the only employee data that changes
+// with the solution, so copying a trial solution costs a few bytes per
+// employee instead of a deep copy of the Employee vector.
+//
+// Both are indexed over the whole loaded instance, so a sub-problem (a subset
+// of the employees, see decompose.h) keeps its indices; `members` lists the
+// indices actually present.
+struct InstanceStore {
+    int n = 0;                               // index space: max Employee::index + 1
+    std::vector<int> members;                // indices present, in input order
+    std::vector<double> lat, lng;            // pickup
+    std::vector<int> ready, due, hard_due;
+    std::vector<uint8_t> veh_pref;           // VehicleCat
+    std::vector<const Employee*> cold;       // the Employee records (null if absent)
+
+    const Employee& employee(int i) const { return *cold[i]; }
+};
+
+// Index space of `emps`: one past the largest Employee::index.
+int employee_index_space(const std::vector<Employee>& emps);
+
+// Views `emps`, which must outlive the store.
+InstanceStore build_instance_store(const std::vector<Employee>& emps);
+
+// Where an employee sits in one solution: vehicle, trip and stop index (-1 if unrouted).
+struct Placement {
+    int vi = -1, ri = -1, pos = -1;
+};
+
+struct TripRef { int vi, ri; };
+
+struct SolutionState {
+    std::vector<uint8_t> routed;
+    std::vector<Placement> at;
+    // Per vehicle, one row per trip: the Route::hash it was built for, then the
+    // AND of the passengers' compatibility rows (compat.h). Kept here, flat,
+    // rather than in Route, so trips stay cheap to copy at any instance size.
+    std::vector<std::vector<uint64_t>> trip_compat;
+    // Non-empty trips bucketed by passenger count (index 0 unused), and per
+    // vehicle and trip its count and position in that bucket (-1 = none).
+    std::vector<std::vector<TripRef>> trips_by_size;
+    struct TripSlot { int size = 0, pos = -1; };
+    std::vector<std::vector<TripSlot>> trip_slot;
+
+    // Re-reads the placement of every passenger of trip ri of vehicle vi,
+    // rebuilds its compatibility row and moves it to its size bucket.
+    void place_trip(const Route& r, int vi, int ri);
+
+    // Compatibility AND row of trip ri of vehicle vi, or null if `r` changed
+    // since its last place_trip() (callers then test per passenger).
+    const uint64_t* trip_mask(const Route& r, int vi, int ri) const;
+};
+
+// Routed flags from Employee::is_routed, placements from the vehicles' stops;
+// sized to employee_index_space(emps).
+SolutionState build_solution_state(const std::vector<Employee>& emps,
+                                   const std::vector<Vehicle>& vehicles);
+
+// Re-reads placements of the trips changed since the last refresh_removal_gains()
+// (Route::removal_gain_stale), e.g. after they were re-sequenced.
+void sync_placements(SolutionState& st, const std::vector<Vehicle>& vehicles);
+
+// Writes the routed flags back into the Employee records.
+void store_routed_flags(const SolutionState& st, std::vector<Employee>& emps);
@@ -7,6 +7,11 @@
 VehicleCat parse_vehicle_category(std::string cat);
 SharingPref parse_sharing_pref(std::string pref);
 
+// One entry of the input's "employees" object. Employee::index is left to the
+// caller; baseline_cost / baseline_time_min are read if the entry carries them
+// (input files keep them in the separate "baseline" array).
+Employee parse_employee(const std::string& id, const mini_json::Value& data);
+
 bool load_from_json(const std::string& filename,
                     std::vector<Employee>& emps,
                     std::vector<Vehicle>& vehs);
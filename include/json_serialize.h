@@ -3,3 +3,6 @@
 #include "mini_json.h"
 
 void write_json(std::ostream& os, const mini_json::Value& v, int indent = 0);
+
+// Same value on a single line with no whitespace (JSON Lines).
+void write_json_line(std::ostream& os, const mini_json::Value& v);
@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+#include "types.h"
+
+// Soft time windows: an employee may reach the office up to
+// PRIORITY_MAX_DELAY[priority] minutes after due_time, paying
+// LATENESS_PENALTY_PER_MIN * PRIORITY_LATE_WEIGHT[priority] per minute
+// (config.h; 1 = most important).
+
+int priority_class(const Employee& e);        // clamped to 1..5
+int max_delay_min(const Employee& e);
+int hard_due(const Employee& e);              // due_time + allowed delay
+double late_rate_per_min(const Employee& e);
+double lateness_penalty(const Employee& e, int office_arrival);
+
+// Brings route.late in line with the passengers currently in the route. The
+// profile stays in due order across calls: an unchanged passenger set (re-timing,
+// re-chaining, re-sequencing) costs one comparison pass, and added passengers
+// are inserted in place rather than re-sorting the trip.
+void update_lateness_profile(LatenessProfile& prof, const MemberList& members);
+
+// Records the trip's own END arrival. Lookups start from the passengers late
+// at that arrival, so arrivals in the same gap between due times (most
+// insertion and re-timing probes) cost O(1); others step one due time at a time.
+void anchor_lateness_profile(LatenessProfile& prof, int office_arrival);
+
+// Penalty of the profile's passengers if END is reached at `office_arrival`,
+// via prefix sums over passengers sorted by due_time.
+double profile_penalty(const LatenessProfile& prof, int office_arrival);
+
+// Minutes of lateness summed over the profile's passengers at `office_arrival`.
+int profile_late_minutes(const LatenessProfile& prof, int office_arrival);
@@ -0,0 +1,49 @@
+#pragma once
+#include <random>
+#include <vector>
+#include "types.h"
+#include "objective.h"
+#include "route_eval.h"
+
+// Route improvement shared by the improvement engines. Moves are priced with the
+// weighted objective and applied through the shared feasibility core, so trip
+// chaining and soft time windows are respected.
+
+// Removes `emp_id` from trip ri of vehicles[vi], re-prices the trip and keeps
+// `obj` (fingerprint included) in sync; unrouted is not touched. Returns false
+// if the trip does not hold the employee.
+bool remove_from_trip(std::vector<Vehicle>& vehicles, int vi, int ri, const std::string& emp_id,
+                      const EmployeeIndex& idx, SolutionObjective& obj);
+
+// First-improvement relocate: each routed employee in random order is taken out
+// and re-inserted at its cheapest feasible position anywhere in the fleet
+// (possibly a new trip); the move is kept only if the score drops.
+// Repeats until a pass makes no move or max_passes is reached.
+// Returns the number of moves applied.
+int relocate_local_search(std::vector<Vehicle>& vehicles,
+                          const EmployeeIndex& idx,
+                          const ObjectiveWeights& w,
+                          SolutionObjective& obj,
+                          std::mt19937& rng,
+                          int max_passes = 3);
+
+// Largest trip the exact re-sequencer accepts; the label sets grow as 2^k * k.
+const int RESEQUENCE_MAX_PICKUPS = 10;
+
+// Exact pickup order for one trip: Held-Karp over (visited set, last pickup)
+// from the trip's real START, with Pareto labels on (partial score, departure
+// time). Leaving d minutes earlier can cost at most d minutes of extra wait and
+// d minutes of extra ride per pickup still to come, so a label dominates another
+// only if it departs no later and its score plus that credit is no higher;
+// dropping dominated labels keeps the optimum. Labels that cannot reach the
+// office by the tightest hard deadline are pruned.
+// Rewrites the trip and returns true only if its score strictly drops.
+bool resequence_trip(Route& route, const Vehicle& v, const EmployeeIndex& idx,
+                     const ObjectiveWeights& w);
+
+// Re-sequences the trips marked stale in their removal-gain cache (i.e. touched
+// since the last refresh), or every trip when `all` is set. A new order is kept
+// only if it does not delay the vehicle's next trip. Keeps `obj` in sync and
+// returns the number of trips improved.
+int resequence_trips(std::vector<Vehicle>& vehicles, const EmployeeIndex& idx,
+                     const ObjectiveWeights& w, SolutionObjective& obj, bool all);
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "types.h"
+
+// Weighted objective used by every solver:
+//   cost * (distance cost + lateness) + time * TIME_VALUE_PER_MIN * (ride + wait)
+//   + unrouted * (#unrouted)
+// Weights come from the instance metadata (objective_cost_weight / _time_weight).
+struct ObjectiveWeights {
+    double cost = 1.0;
+    double ride = 0.0;            // per passenger-minute in vehicle
+    double wait = 0.0;            // per vehicle-minute idling for ready_time
+    double unrouted = 1e9;        // lexicographic: routing everyone comes first
+};
+
+ObjectiveWeights objective_weights_from_instance();
+
+// Per-route components; the solution objective is their sum.
+struct RouteObjective {
+    double dist_cost = 0.0;
+    double lateness = 0.0;
+    double ride_min = 0.0;
+    double wait_min = 0.0;
+};
+
+// Solution-level totals maintained incrementally: a move subtracts the old
+// components of each route it touched and adds the new ones.
+struct SolutionObjective {
+    double dist_cost = 0.0;
+    double lateness = 0.0;
+    double ride_min = 0.0;
+    double wait_min = 0.0;
+    int unrouted = 0;
+    // Solution fingerprint (zobrist.h): seeded by evaluate_solution(), kept by
+    // the ALNS moves (apply_removals, commit_insertion, resequence_trips).
+    uint64_t hash = 0;
+
+    void add(const RouteObjective& r);
+    void remove(const RouteObjective& r);
+    void replace(const RouteObjective& before, const RouteObjective& after) { remove(before); add(after); }
+    double score(const ObjectiveWeights& w) const;
+};
+
+// Fills route.ride_minutes / route.wait_minutes from the simulated stop times.
+void refresh_route_times(Route& route);
+
+RouteObjective route_objective(const Route& route);
+double route_score(const Route& route, const ObjectiveWeights& w);
+
+// Sum of trip costs, skipping empty START -> END trips that are never driven.
+double vehicle_cost(const Vehicle& v);
+
+// Full rescan; used to seed the incremental totals and for reporting.
+SolutionObjective evaluate_solution(const std::vector<Employee>& emps, const std::vector<Vehicle>& vehs);
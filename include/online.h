@@ -0,0 +1,33 @@
+#pragma once
+#include <iosfwd>
+#include <vector>
+#include "types.h"
+#include "alns.h"
+
+// Dynamic mode: the plan stays in memory and is re-optimized per event.
+// Events arrive one JSON object per line:
+//   {"type":"add","employee_id":"E40","employee":{...input employee fields...}}
+//   {"type":"cancel","employee_id":"E07"}
+//   {"type":"delay","vehicle_id":"V02","minutes":15}
+//   {"type":"unavailable","vehicle_id":"V03"}
+//   {"type":"advance","time":"08:40"}
+//   {"type":"quit"}
+// Trips that have left by the current time are frozen (their passengers are
+// on board or being collected); everything else is open. After each event
+// the open part is repaired with cheapest insertion and polished by a short
+// ALNS burst, and the updated plan is answered as one JSON line.
+struct OnlineConfig {
+    int burst_iterations = 100;    // ALNS iterations per event
+    int burst_no_improve = 50;     // burst stops early after this many non-improving iterations
+};
+
+// Runs the event loop until "quit" or end of input. employees/vehicles hold the
+// starting plan (as loaded, Employee::index == position) and the final one on
+// return (cancelled employees removed).
+void run_event_stream(std::vector<Employee>& employees,
+                      std::vector<Vehicle>& vehicles,
+                      const ALNSConfig& alns_cfg,
+                      const OnlineConfig& cfg,
+                      std::istream& in,
+                      std::ostream& out,
+                      bool debug);
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "types.h"
+
+// Memo of simulated trips: simulate_route() results, and the candidate trips
+// of insert_pickup()/simulate_insertion() (route_eval.h).
+//
+// ALNS keeps removing and re-inserting the same few passengers, so the same
+// trips get re-simulated and the same insertions re-priced many times. A
+// trip's timing depends only on the vehicle's speed, the START departure time
+// and the stop sequence, so those make the key; cost_per_km only scales
+// total_cost, which a hit recomputes. Candidates are looked up by the key of
+// the sequence they would have, before their stops are built.
+//
+// Most candidates are priced once and never again, so a trip is only stored
+// the second time it misses (a per-shard bitmap remembers first misses), and
+// replacement is CLOCK, so a hit only sets a bit. The cache is bounded and
+// split into independently locked shards so concurrent solves (decomposition,
+// time layers) can share it. Entries are preallocated per shard on first use;
+// a hit copies the stored trip and never touches the heap.
+//
+// The cache must be cleared when the instance changes (build_node_table()
+// does this), since node indices and passenger data are baked into entries.
+
+struct RouteCacheStats {
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;            // currently held
+    size_t capacity = 0;
+    size_t bytes = 0;              // memory held by allocated shards
+};
+
+// Total entries across shards; 0 disables the cache. Clears it.
+void route_cache_configure(size_t capacity);
+void route_cache_clear();
+RouteCacheStats route_cache_stats();
+
+// Stop sequence of a trip, `base`, or `base` with pickup node `node` inserted
+// before index `pos` when pos > 0.
+struct TripSequence {
+    const StopList& base;
+    int node = -1;
+    int pos = -1;
+};
+
+// Key of a trip with route_hash() `stops_hash` leaving START at `start`.
+uint64_t route_cache_key(uint64_t stops_hash, int start, double speed_kmh);
+// Key of the trip as simulate_route() would see it on vehicle v.
+uint64_t route_cache_key(const Route& route, const Vehicle& v);
+
+// On a hit, replaces `route` with the cached trip (keeping the caller's
+// max_capacity, total_cost from v) and sets `feasible`. `route` may be `seq.base`.
+bool route_cache_get(uint64_t key, const Vehicle& v, const TripSequence& seq, Route& route, bool& feasible);
+// On a hit, copies only the timed stops.
+bool route_cache_get_stops(uint64_t key, double speed_kmh, const TripSequence& seq, StopList& stops);
+void route_cache_put(uint64_t key, const Vehicle& v, const Route& route, bool feasible);
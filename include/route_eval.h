@@ -0,0 +1,77 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "types.h"
+
+// Shared feasibility core used by the Solomon constructor and ALNS.
+// Trip shape: START -> pickups... -> END(office); every passenger is dropped at END.
+//
+// Feasibility rules:
+//  - Each pickup begins no earlier than employee.ready_time (wait if early).
+//  - END arrival must be <= hard_due() (latest_drop + priority delay) for every passenger.
+//  - Trip r+1 of a vehicle cannot leave before trip r reaches the office.
+
+const int SERVICE_PICKUP_MIN = 2;
+
+// Fills g_nodes for this instance and points every vehicle at its depot START
+// node. Called by the loaders; emps[i].index must equal i.
+void build_node_table(const std::vector<Employee>& emps, std::vector<Vehicle>& vehs);
+
+// Untimed pickup stop for `emp` (times are set by simulate_route/insertion).
+Stop pickup_stop(const Employee& emp);
+
+using EmployeeIndex = std::unordered_map<std::string, const Employee*>;
+EmployeeIndex build_employee_index(const std::vector<Employee>& emps);
+
+// Vehicle category, pairwise compatibility with the trip's passengers and trip
+// capacity allow `e` in `route`. With the trip's AND row (`trip_mask`, see
+// SolutionState::trip_mask) pairing is one bit test, else one per passenger.
+bool check_compatibility(const Vehicle& v, const Employee& e, const Route& route,
+                         const uint64_t* trip_mask = nullptr);
+
+// Empty START -> END trip leaving v.current_loc at v.available_time.
+Route make_empty_trip(const Vehicle& v);
+
+// Empty trip that leaves the office when the vehicle's last trip ends.
+Route make_next_trip(const Vehicle& v);
+
+// START -> END with no pickups.
+bool is_empty_trip(const Route& r);
+
+// Copy of v with no routes, standing where trip `first` would leave from: at
+// the office when its last non-empty earlier trip ends, or at its original
+// location/time if there is none.
+Vehicle vehicle_before_trip(const Vehicle& v, size_t first);
+
+// Copy of the fleet with no passengers: one empty trip per vehicle leaving from
+// its original location/time (read back from the first trip's START).
+std::vector<Vehicle> blank_fleet(const std::vector<Vehicle>& vehicles);
+
+// Recomputes distance, cost, lateness and time components from the current
+// stop times (no re-timing). Returns false if the END deadline is violated.
+bool finalize_route(Route& route, const Vehicle& v, const EmployeeIndex& idx);
+
+// Full re-timing of the trip from its START departure, then finalize_route().
+bool simulate_route(Route& route, const Vehicle& v, const EmployeeIndex& idx);
+
+// Insert a pickup for `emp` before existing index `insert_before_idx` (1..size-1).
+// Stops before the insertion keep their times; only the suffix is re-timed.
+// END feasibility is O(1) thanks to route.late.hard_deadline.
+bool simulate_insertion(const Route& route, const Employee& emp, int insert_before_idx,
+                        double speed_kmh, const EmployeeIndex& idx,
+                        StopList& out_stops, std::string& fail_reason);
+
+// simulate_insertion() then finalize_route(): `out` becomes the trip with the
+// pickup inserted (its max_capacity is kept). Both steps are skipped when the
+// route cache (route_cache.h) already holds that trip.
+bool insert_pickup(const Route& route, const Employee& emp, int insert_before_idx,
+                   const Vehicle& v, const EmployeeIndex& idx, Route& out, std::string& fail_reason);
+
+// True if trip r may end at `end_time` without delaying trip r+1.
+bool chain_has_slack(const Vehicle& v, size_t r, int end_time);
+
+// Pushes trips after `changed` forward so each leaves no earlier than its
+// predecessor reaches the office, re-simulating the ones that move.
+// Returns false if a moved trip becomes infeasible (vehicle left partially updated).
+bool rechain_trips(Vehicle& v, size_t changed, const EmployeeIndex& idx);
@@ -0,0 +1,148 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+// Vector with N elements of inline storage, for trivially copyable T only.
+// Trips are short (vehicle capacity + START/END), so Route copies in the
+// insertion loops stay inside the object and never reach the allocator;
+// longer contents spill to the heap transparently. Iterators are raw pointers,
+// so <algorithm> works as with std::vector.
+template <class T, size_t N>
+class SmallVec {
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVec holds trivially copyable types only");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using size_type = size_t;
+
+    SmallVec() : data_(inline_buf()), size_(0), cap_(N) {}
+    explicit SmallVec(size_t n, const T& v = T()) : SmallVec() { assign(n, v); }
+    SmallVec(const SmallVec& o) : SmallVec() { assign(o.begin(), o.end()); }
+    SmallVec(SmallVec&& o) noexcept : SmallVec() { take(o); }
+    ~SmallVec() { release(); }
+
+    SmallVec& operator=(const SmallVec& o) {
+        if (this != &o) assign(o.begin(), o.end());
+        return *this;
+    }
+    SmallVec& operator=(SmallVec&& o) noexcept {
+        if (this != &o) { release(); data_ = inline_buf(); cap_ = N; size_ = 0; take(o); }
+        return *this;
+    }
+
+    T* begin() { return data_; }
+    T* end() { return data_ + size_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return cap_; }
+    bool empty() const { return size_ == 0; }
+
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+    T& front() { return data_[0]; }
+    const T& front() const { return data_[0]; }
+    T& back() { return data_[size_ - 1]; }
+    const T& back() const { return data_[size_ - 1]; }
+
+    void reserve(size_t n) { if (n > cap_) grow(n); }
+    void clear() { size_ = 0; }
+
+    void resize(size_t n, const T& v = T()) {
+        reserve(n);
+        for (size_t i = size_; i < n; i++) data_[i] = v;
+        size_ = (uint32_t)n;
+    }
+    void assign(size_t n, const T& v) {
+        const T copy = v;
+        size_ = 0;
+        resize(n, copy);
+    }
+    void assign(const T* first, const T* last) {
+        const size_t n = (size_t)(last - first);
+        size_ = 0;
+        reserve(n);
+        if (n) std::memmove(data_, first, n * sizeof(T));
+        size_ = (uint32_t)n;
+    }
+
+    void push_back(const T& v) {
+        const T copy = v;
+        if (size_ == cap_) grow(cap_ * 2);
+        data_[size_++] = copy;
+    }
+    void pop_back() { size_--; }
+
+    T* insert(const T* pos, const T& v) {
+        const size_t at = (size_t)(pos - data_);
+        const T copy = v;
+        if (size_ == cap_) grow(cap_ * 2);
+        std::memmove(data_ + at + 1, data_ + at, (size_ - at) * sizeof(T));
+        data_[at] = copy;
+        size_++;
+        return data_ + at;
+    }
+    T* insert(const T* pos, const T* first, const T* last) {
+        const size_t at = (size_t)(pos - data_);
+        const size_t n = (size_t)(last - first);
+        if (n == 0) return data_ + at;
+        if (first >= data_ && first < data_ + size_) {
+            SmallVec tmp;                      // source aliases us; copy before shifting
+            tmp.assign(first, last);
+            return insert(data_ + at, tmp.begin(), tmp.end());
+        }
+        if (size_ + n > cap_) grow(size_ + n > cap_ * 2 ? size_ + n : cap_ * 2);
+        std::memmove(data_ + at + n, data_ + at, (size_ - at) * sizeof(T));
+        std::memcpy(data_ + at, first, n * sizeof(T));
+        size_ += (uint32_t)n;
+        return data_ + at;
+    }
+
+    T* erase(const T* pos) { return erase(pos, pos + 1); }
+    T* erase(const T* first, const T* last) {
+        const size_t a = (size_t)(first - data_), b = (size_t)(last - data_);
+        std::memmove(data_ + a, data_ + b, (size_ - b) * sizeof(T));
+        size_ -= (uint32_t)(b - a);
+        return data_ + a;
+    }
+
+private:
+    T* inline_buf() { return reinterpret_cast<T*>(buf_); }
+    bool on_heap() const { return data_ != reinterpret_cast<const T*>(buf_); }
+
+    // Spills go through the global operator new, so the allocation counter
+    // (alloc_counter.h) sees them like any other heap allocation.
+    void grow(size_t n) {
+        T* p = static_cast<T*>(::operator new(n * sizeof(T)));
+        if (size_) std::memcpy(p, data_, size_ * sizeof(T));
+        release();
+        data_ = p;
+        cap_ = (uint32_t)n;
+    }
+    void release() { if (on_heap()) ::operator delete(data_); }
+
+    // Moves o's contents into *this (currently empty and inline).
+    void take(SmallVec& o) {
+        if (o.on_heap()) {
+            data_ = o.data_; size_ = o.size_; cap_ = o.cap_;
+            o.data_ = o.inline_buf(); o.cap_ = N;
+        } else {
+            if (o.size_) std::memcpy(data_, o.data_, o.size_ * sizeof(T));
+            size_ = o.size_;
+        }
+        o.size_ = 0;
+    }
+
+    T* data_;
+    uint32_t size_;
+    uint32_t cap_;
+    alignas(T) unsigned char buf_[N * sizeof(T)];
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <memory_resource>
+#include <vector>
+#include "types.h"
+
+// Uniform lat/lng grid over a fixed point set (employee pickups), for
+// neighbour queries that only touch the cells around the query point.
+struct SpatialGrid {
+    double lat0 = 0.0, lng0 = 0.0;
+    double cell_deg = 1.0;
+    int rows = 0, cols = 0;
+    std::vector<std::vector<int>> cells;   // point indices per cell, row-major
+    std::vector<Location> pts;
+
+    // Sizes cells so that each holds about `per_cell` points on average.
+    void build(const std::vector<Location>& points, int per_cell = 4);
+
+    // Indices of the k points closest to `at` (by get_dist), nearest first.
+    // Scans rings of cells outwards until the k-th candidate is provably closest.
+    // Result and scratch come from `mr` (an iteration arena inside ALNS).
+    std::pmr::vector<int> nearest(const Location& at, int k,
+                                  std::pmr::memory_resource* mr = std::pmr::get_default_resource()) const;
+
+    int cell_row(double lat) const;
+    int cell_col(double lng) const;
+};
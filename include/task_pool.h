@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fork-join pool for the data-parallel loops inside one search step (regret
+// scans, removal-gain pricing, the constructor's per-vehicle scan).
+//
+// parallel_for(n, grain, fn) calls fn(i) once for every i in [0, n) and
+// returns when all calls are done. The range is split evenly over the
+// participants (the calling thread is one of them); each takes `grain`
+// indices at a time from the front of its own range, and a participant that
+// runs dry steals the back half of the next non-empty range. Only the
+// assignment of indices to threads depends on timing: callers write results
+// per index and reduce them afterwards in index order, so results are the
+// same for any thread count.
+//
+// Loops of at most `grain` items, a pool of one thread, nested calls and calls
+// made while another thread is using the pool all run inline on the caller.
+// Heap allocations made by workers during a loop are credited to the caller's
+// heap_allocations() count.
+class TaskPool {
+public:
+    explicit TaskPool(int threads);
+    ~TaskPool();
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    int threads() const { return threads_; }
+
+    template <class Fn>
+    void parallel_for(int n, int grain, Fn&& fn) {
+        run(n, grain, [](void* ctx, int i) { (*static_cast<Fn*>(ctx))(i); }, &fn);
+    }
+
+private:
+    using Call = void (*)(void*, int);
+    void run(int n, int grain, Call call, void* ctx);
+    void work(int self);
+    bool take(int self, int& begin, int& end);
+    void worker_main(int self);
+
+    int threads_;
+    std::vector<std::thread> workers_;
+    std::unique_ptr<std::atomic<uint64_t>[]> ranges_;   // per participant: begin << 32 | end
+    std::atomic<bool> busy_{false};
+    std::atomic<int> pending_{0};                       // indices not yet finished
+    std::atomic<int> active_{0};                        // workers inside the current job
+    std::atomic<uint64_t> allocs_{0};                   // heap allocations by workers in the job
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    uint64_t generation_ = 0;                           // bumped per job, guarded by m_
+    bool open_ = false;                                 // current job still accepts workers
+    bool stop_ = false;
+    Call call_ = nullptr;
+    void* ctx_ = nullptr;
+    int grain_ = 1;
+};
+
+// Process-wide pool used by the solver. 0 = hardware concurrency, 1 = serial.
+// Takes effect on the next task_pool() call; not while a loop is running.
+void task_pool_configure(int threads);
+TaskPool& task_pool();
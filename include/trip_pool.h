@@ -0,0 +1,79 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "types.h"
+#include "alns.h"
+#include "route_eval.h"
+
+// Trip-pool recombination. With 3-6 seats and tight windows the feasible
+// passenger sets per vehicle type can be enumerated; together with every trip
+// the ALNS produced, the pool is recombined by a set-partitioning selection
+// (randomized greedy + insertion repair) under fleet and trip-chaining limits.
+
+struct TripPoolConfig {
+    int max_set_size = 4;          // passengers per enumerated trip (also capped by capacity)
+    int neighbours = 10;           // compatible neighbours per employee in the enumeration
+    size_t max_trips = 200000;     // pool size cap
+    int rounds = 30;               // randomized greedy selections
+    double noise = 0.15;           // relative noise on trip ranking after the first round
+    int ls_passes = 2;             // relocate passes on the recombined solution
+};
+
+// Trips are interchangeable between vehicles with the same category, capacity and speed.
+struct TripType {
+    VehicleCat category;
+    int capacity;
+    double speed_kmh;
+    double min_cost_per_km;        // cheapest vehicle of the type, for ranking
+};
+
+struct PoolTrip {
+    int type = 0;
+    std::vector<int> members;      // sorted instance indices
+    std::vector<int> order;        // pickup order
+    double dist_km = 0.0;          // first pickup -> ... -> office
+};
+
+class TripPool {
+public:
+    void init(const std::vector<Employee>& instance, const std::vector<Vehicle>& vehicles);
+
+    int type_of(const Vehicle& v) const;
+    const std::vector<TripType>& types() const { return types_; }
+    const std::vector<PoolTrip>& trips() const { return trips_; }
+    const std::vector<Employee>& instance() const { return *instance_; }
+    int index_of(const std::string& emp_id) const { return pos_.at(emp_id); }
+
+    // Adds a trip, or keeps the shorter order if the passenger set is known.
+    // Returns true if the pool grew.
+    bool add(int type, const std::vector<int>& order, double dist_km);
+
+    // Collects a planned trip of vehicle v (no-op for empty trips).
+    void add_route(const Route& r, const Vehicle& v);
+
+private:
+    const std::vector<Employee>* instance_ = nullptr;
+    std::unordered_map<std::string, int> pos_;
+    std::vector<TripType> types_;
+    std::vector<PoolTrip> trips_;
+    std::unordered_map<std::string, int> by_key_;
+};
+
+// Shortest feasible pickup order of `members` for a vehicle type: bitset DP over
+// (visited set, last pickup), starting at the first pickup's ready time.
+// Returns false if no order reaches the office within every hard deadline.
+bool best_pickup_order(const std::vector<Employee>& instance, const std::vector<int>& members,
+                       double speed_kmh, std::vector<int>& order, double& dist_km);
+
+// Adds every feasible passenger set up to cfg.max_set_size per vehicle type,
+// growing sets only along compatible neighbours. Returns the number of trips added.
+size_t enumerate_trips(TripPool& pool, const TripPoolConfig& cfg);
+
+// Runs ALNS while collecting its trips, enumerates the pool and keeps the best
+// of the ALNS result and the set-partitioning recombination.
+void solve_trip_pool(std::vector<Employee>& employees,
+                     std::vector<Vehicle>& vehicles,
+                     const ALNSConfig& alns_cfg,
+                     const TripPoolConfig& cfg,
+                     bool debug);
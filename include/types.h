@@ -2,6 +2,9 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <climits>
+#include <cstdint>
+#include "small_vec.h"
 
 using std::string;
 using std::vector;
@@ -27,23 +30,79 @@ struct Employee {
     SharingPref share_pref;
     bool is_routed;
     double baseline_cost;
+    double baseline_time = 0.0;        // baseline_time_min from the input
+    int index = -1;                    // position in the loaded employee list (compat bitsets)
 };
 
+// Every place a trip can visit, built once per instance (build_node_table()):
+// node i < n_pickups is the pickup of the employee with index i, then the
+// office END, a START at the office and one START per vehicle depot.
+// Stops refer to nodes by index, which keeps a Stop at 16 bytes.
+struct NodeTable {
+    vector<string> ids;                // employee id, "START" or "END"
+    vector<Location> locs;
+    vector<int> ready;                 // pickup nodes: the employee's ready_time
+    int n_pickups = 0;
+    int end_node = -1;
+    int office_start_node = -1;
+};
+
+extern NodeTable g_nodes;
+
 struct Stop {
-    string emp_id;
-    Location loc;
+    int node;
     int arrival_time;
     int begin_service;
     int departure_time;
-    bool is_pickup;
+
+    const string& emp_id() const { return g_nodes.ids[node]; }
+    const Location& loc() const { return g_nodes.locs[node]; }
+    bool is_pickup() const { return node < g_nodes.n_pickups; }
+};
+static_assert(sizeof(Stop) == 16, "Stop should stay four ints");
+
+// Inline capacity covers the largest vehicle (6 seats + START/END); bigger
+// contents spill to the heap.
+using StopList = SmallVec<Stop, 8>;
+using MemberList = SmallVec<const Employee*, 8>;   // a trip's passengers
+
+// Prefix summary of a trip's passengers for soft time windows (see lateness.h).
+// Everyone in a trip is dropped at the same END arrival, so the trip only needs
+// the tightest hard deadline plus sorted due times to price any arrival.
+struct LatenessProfile {
+    int hard_deadline = INT_MAX;       // latest END arrival allowed for every passenger
+    int anchor = 0;                    // passengers late at the trip's own END arrival
+    SmallVec<int, 8> node;             // passengers (Employee::index), in due order
+    SmallVec<int, 8> due;              // passenger due times, ascending
+    SmallVec<double, 8> rate_prefix;   // sum of penalty rates over due[0..i)
+    SmallVec<double, 8> rate_due_prefix; // sum of rate * due over due[0..i)
+    SmallVec<long long, 8> due_prefix; // sum of due over due[0..i)
 };
 
 struct Route {
-    vector<Stop> stops;
+    StopList stops;
     int current_capacity;
     int max_capacity;
     double total_distance;
     double total_cost;
+    LatenessProfile late;
+    double lateness_penalty = 0.0;     // penalty at the current END arrival
+    int late_minutes = 0;
+    int ride_minutes = 0;              // sum over passengers of (END arrival - pickup departure)
+    int wait_minutes = 0;              // vehicle idle time waiting for ready_time
+    // ALNS worst-removal cache: estimated objective saving of dropping each stop,
+    // indexed like `stops`. finalize_route() marks it stale after every change.
+    SmallVec<double, 8> removal_gain;
+    bool removal_gain_stale = true;
+    // Geometric summary over all stops (START..END) for insertion lower bounds:
+    // every stop lies within radius_km of centroid; max_edge_km is the longest leg.
+    Location centroid = {0.0, 0.0};
+    double radius_km = 0.0;
+    double max_edge_km = 0.0;
+    // Length of the leg into each stop (0 for START), indexed like `stops`.
+    SmallVec<double, 8> leg_km;
+    // Structural fingerprint of the stop sequence (zobrist.h), set by finalize_route().
+    uint64_t hash = 0;
 };
 
 struct Vehicle {
@@ -56,7 +115,7 @@ struct Vehicle {
     int available_time = 0; // minutes since midnight
     // Multi-trip state: chain both time AND physical location across trips.
     // Without this, the vehicle "teleports" back to the depot between trips.
-    Location current_loc;
+    int current_node = -1;   // START node (NodeTable) of the vehicle's current location
     
     vector<Route> routes;  // Multiple trips
     double total_cost;
@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "types.h"
+
+// Warm start from a previous plan (the output JSON of an earlier run).
+// Trips are rebuilt vehicle by vehicle in their recorded pickup order and
+// re-timed against today's roster: departed employees and passengers that no
+// longer fit are dropped, vehicles that left the fleet lose their trips. Every
+// employee not placed that way (new ones included) then gets a cheapest
+// insertion, so a short ALNS run is enough to finish the plan.
+struct WarmStartStats {
+    int kept = 0;                      // passengers rebuilt in their previous trip
+    int departed = 0;                  // previous passengers no longer in the roster
+    int dropped = 0;                   // previous passengers whose trip no longer fits them
+    int inserted = 0;                  // employees placed by insertion afterwards
+};
+
+// Vehicles must have no routes yet. Returns false if the plan cannot be read
+// (the caller should then build from scratch).
+bool warm_start_from_output(const std::string& plan_file,
+                            std::vector<Employee>& employees,
+                            std::vector<Vehicle>& vehicles,
+                            WarmStartStats& stats,
+                            bool debug);
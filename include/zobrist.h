@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "types.h"
+
+// Structural fingerprints of trips and solutions (Zobrist-style).
+//
+// A trip hashes to the XOR of one key per leg (from-node, to-node), so it
+// depends on the exact stop sequence but not on the times, and inserting or
+// removing a stop only swaps the keys of the legs it touches. finalize_route()
+// keeps Route::hash current. A solution is the XOR of its trips' keys, each
+// trip hash salted with its position (vehicle, trip) so that equal trips in
+// different places, such as two empty ones, do not cancel. Replacing a trip
+// updates it in O(1): XOR out the old trip's key and XOR in the new one.
+
+// Key of the leg from node `from` to node `to` (NodeTable indices).
+uint64_t leg_key(int from, int to);
+
+uint64_t route_hash(const StopList& stops);
+
+// Contribution of `r` as trip ri of vehicle vi.
+uint64_t trip_key(const Route& r, size_t vi, size_t ri);
+
+// XOR of trip_key() over all trips (full rescan).
+uint64_t solution_hash(const std::vector<Vehicle>& vehicles);
+
+// Bounded, lossy set of 64-bit fingerprints: 4-way set associative with
+// round-robin replacement in each set, allocated once. Old entries are evicted
+// when a set is full, so contains() may forget but never reports a fingerprint
+// that was not inserted (0 marks an empty slot and is stored as 1).
+class FingerprintSet {
+public:
+    explicit FingerprintSet(size_t capacity = 1 << 16);
+
+    bool contains(uint64_t h) const;
+    // Returns true if h was not present.
+    bool insert(uint64_t h);
+
+    size_t inserted() const { return inserted_; }     // distinct insertions so far
+
+private:
+    static constexpr size_t WAYS = 4;
+    std::vector<uint64_t> slots_;
+    std::vector<uint8_t> next_;                       // replacement cursor per set
+    size_t sets_mask_ = 0;
+    size_t inserted_ = 0;
+};
@@ -0,0 +1,61 @@
+#include "acceptance.h"
+#include <algorithm>
+#include <cmath>
+
+Acceptance::Acceptance(const AcceptanceConfig& cfg, double T0, double cooling,
+                       double initial_score, double initial_cost)
+    : cfg_(cfg), scale_(std::max(1.0, initial_cost)), T0_(T0), cooling_(cooling), level_(0.0) {
+    const double p = std::min(std::max(cfg_.start_accept, 1e-6), 1.0 - 1e-6);
+    if (cfg_.kind == ACCEPT_SA && cfg_.calibrate)
+        T0_ = -cfg_.start_worsening * scale_ / std::log(p);
+    if (cfg_.kind == ACCEPT_LAHC)
+        history_.assign(std::max(1, cfg_.lahc_length), initial_score);
+    level_ = cfg_.kind == ACCEPT_SA ? T0_ : cfg_.kind == ACCEPT_LAHC ? initial_score
+                                              : cfg_.start_worsening * scale_;
+}
+
+const char* Acceptance::name() const {
+    switch (cfg_.kind) {
+        case ACCEPT_SA: return cfg_.calibrate ? "SA (calibrated)" : "SA (fixed)";
+        case ACCEPT_RRT: return "record-to-record";
+        case ACCEPT_THRESHOLD: return "threshold";
+        case ACCEPT_LAHC: return "late acceptance";
+    }
+    return "?";
+}
+
+bool Acceptance::accept(double candidate, double current, double best, double progress,
+                        std::mt19937& rng) {
+    progress = std::min(std::max(progress, 0.0), 1.0);
+    const double delta = candidate - current;
+    bool ok = delta <= 0.0;
+
+    switch (cfg_.kind) {
+        case ACCEPT_SA: {
+            if (cfg_.calibrate) level_ = T0_ * std::pow(cfg_.end_temperature, progress);
+            if (!ok) {
+                std::uniform_real_distribution<double> U01(0.0, 1.0);
+                ok = U01(rng) < std::exp(-delta / std::max(1e-9, level_));
+            }
+            if (!cfg_.calibrate) level_ *= cooling_;
+            break;
+        }
+        case ACCEPT_RRT:
+            level_ = cfg_.start_worsening * scale_ * (1.0 - progress);
+            ok = ok || candidate <= best + level_;
+            break;
+        case ACCEPT_THRESHOLD:
+            level_ = cfg_.start_worsening * scale_ * (1.0 - progress);
+            ok = ok || delta < level_;
+            break;
+        case ACCEPT_LAHC: {
+            double& late = history_[step_ % history_.size()];
+            ok = ok || candidate <= late;
+            late = ok ? candidate : current;
+            level_ = history_[(step_ + 1) % history_.size()];
+            break;
+        }
+    }
+    step_++;
+    return ok;
+}
@@ -0,0 +1,1017 @@
+#include "alns_operators.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <iostream>
+#include <new>
+#include <thread>
+#include "geo.h"
+#include "config.h"
+#include "lateness.h"
+#include "compat.h"
+#include "arena.h"
+#include "insertion_batch.h"
+#include "task_pool.h"
+#include "zobrist.h"
+
+// ------------------------------------------------------------
+// REQUIRED HOOKS: wired to the shared feasibility core (route_eval.h)
+// ------------------------------------------------------------
+//
+// 1) Evaluate & recompute one route after modifying stops.
+//    Updates route feasibility (return bool), route.total_cost, route.total_distance,
+//    lateness/time components and stop arrival/departure times.
+//
+static bool HOOK_simulate_route(Route& route, const Vehicle& vehicle,
+                                const EmployeeIndex& idx) {
+    return simulate_route(route, vehicle, idx);
+}
+
+//
+// 2) Remove employee from route (by node at a known stop index). Must erase
+//    exactly the pickup stop. Should NOT break START/END.
+//    After removal you should call HOOK_simulate_route(route,...).
+//
+static bool HOOK_remove_employee_from_route(Route& route, int node, int pos) {
+    if (pos <= 0 || pos >= (int)route.stops.size() || route.stops[pos].node != node) {
+        // Placement out of date: fall back to a scan of the trip.
+        pos = -1;
+        for (int p = 1; p + 1 < (int)route.stops.size(); p++)
+            if (route.stops[p].node == node) { pos = p; break; }
+        if (pos < 0) return false;
+    }
+    route.stops.erase(route.stops.begin() + pos);
+    return true;
+}
+
+//
+// 3) Try to insert employee into a route at best position.
+//    Returns true if inserted (feasible) and updates route.
+//    You can reuse your Solomon "best insertion position" logic.
+//    If you already have a function like best_insertion(route, emp, vehicle) use it.
+//    With blink_rate > 0 each position is skipped with that probability (SISR blinks).
+//
+static bool HOOK_best_insert(Route& route,
+                             const Vehicle& vehicle,
+                             const Employee& emp,
+                             const EmployeeIndex& idx,
+                             const ObjectiveWeights& w,
+                             double blink_rate = 0.0,
+                             std::mt19937* rng = nullptr) {
+    // All positions are priced in one batch pass; only the best is re-timed
+    // in full (same pick as best_insert_scalar(), see insertion_batch.h).
+    return best_insert_batch(route, vehicle, emp, idx, w, blink_rate, rng);
+}
+
+// Optional: hook into your 2-opt if you have it (keep false by default)
+static void HOOK_two_opt_vehicle(Vehicle& vehicle, bool debug) {
+    (void)vehicle; (void)debug;
+    // TODO: call your two-opt-all-routes on this vehicle if you implemented it.
+}
+
+
+// ------------------------------------------------------------
+// Internal helpers
+// ------------------------------------------------------------
+struct LocatedEmp {
+    int node;                      // Employee::index
+    int veh_idx;
+    int route_idx;
+};
+
+static ScratchVec<LocatedEmp> collect_routed_emps(const std::vector<Vehicle>& vehicles) {
+    auto out = scratch_vec<LocatedEmp>();
+    for (int vi = 0; vi < (int)vehicles.size(); vi++) {
+        const auto& v = vehicles[vi];
+        for (int ri = 0; ri < (int)v.routes.size(); ri++) {
+            const auto& r = v.routes[ri];
+            for (const auto& s : r.stops) {
+                if (s.is_pickup()) out.push_back({s.node, vi, ri});
+            }
+        }
+    }
+    return out;
+}
+
+// Similarity metric for Shaw removal: time window proximity, read from the
+// instance store's hot arrays.
+static double similarity(const InstanceStore& st, int a, int b) {
+    return std::abs(st.ready[a] - st.ready[b]) + std::abs(st.due[a] - st.due[b]);
+}
+
+// ------------------------------------------------------------
+// Destroy operators
+// ------------------------------------------------------------
+static ScratchVec<int> destroy_random(const ALNSContext& ctx,
+                                      const SolutionState&,
+                                      const std::vector<Vehicle>& vehicles,
+                                      int q) {
+    std::mt19937& rng = ctx.rng;
+    auto routed = collect_routed_emps(vehicles);
+    std::shuffle(routed.begin(), routed.end(), rng);
+
+    auto removed = scratch_vec<int>();
+    for (int i = 0; i < (int)routed.size() && (int)removed.size() < q; i++) {
+        removed.push_back(routed[i].node);
+    }
+    return removed;
+}
+
+static ScratchVec<int> destroy_shaw(const ALNSContext& ctx,
+                                    const SolutionState&,
+                                    const std::vector<Vehicle>& vehicles,
+                                    int q) {
+    std::mt19937& rng = ctx.rng;
+    auto routed = collect_routed_emps(vehicles);
+    if (routed.empty()) return scratch_vec<int>();
+
+    std::uniform_int_distribution<int> pick(0, (int)routed.size()-1);
+    const int seed = routed[pick(rng)].node;
+
+    // rank by similarity (low = more similar)
+    struct Cand { int node; double sim; };
+    auto cands = scratch_vec<Cand>();
+    cands.reserve(routed.size());
+    for (const auto& le : routed) cands.push_back({le.node, similarity(ctx.store, seed, le.node)});
+    std::sort(cands.begin(), cands.end(), [](const Cand& x, const Cand& y){ return x.sim < y.sim; });
+
+    auto removed = scratch_vec<int>();
+    for (int i = 0; i < (int)cands.size() && (int)removed.size() < q; i++) {
+        removed.push_back(cands[i].node);
+    }
+    return removed;
+}
+
+// Worst removal: “contribution” = estimated objective drop when the employee is removed,
+// read from the per-route removal-gain cache (see refresh_removal_gains).
+// Candidates are ranked by gain and drawn at rank floor(y^p * n), y ~ U(0,1), so a
+// larger p sticks closer to the strict worst order (Ropke & Pisinger).
+// The drawn ranks depend only on how many candidates remain, so they are drawn
+// first and mapped to ranks in the full order; then only the prefix down to the
+// deepest one is ordered: O(N + m log m) for deepest rank m instead of a full
+// sort plus an O(N) erase per draw.
+static ScratchVec<int> destroy_worst(const ALNSContext& ctx,
+                                     const std::vector<Vehicle>& vehicles,
+                                     int q,
+                                     double p) {
+    struct Cand { int node; double gain; };
+    auto scored = scratch_vec<Cand>();
+
+    for (const auto& v : vehicles) {
+        for (const auto& r : v.routes) {
+            if (r.removal_gain.size() != r.stops.size()) continue;   // stale; never priced
+            for (size_t i = 0; i < r.stops.size(); i++) {
+                if (r.stops[i].is_pickup()) scored.push_back({r.stops[i].node, r.removal_gain[i]});
+            }
+        }
+    }
+
+    std::uniform_real_distribution<double> U01(0.0, 1.0);
+    auto ranks = scratch_vec<size_t>();     // in draw order, ranks in the full order
+    auto taken = scratch_vec<size_t>();     // the same, ascending
+    const size_t n = scored.size();
+    for (size_t left = n; left > 0 && (int)ranks.size() < q; left--) {
+        size_t k = (size_t)(std::pow(U01(ctx.rng), p) * left);
+        k = std::min(k, left - 1);
+        // k-th of the remaining = k-th of the full order after skipping taken ranks.
+        for (size_t t : taken) if (t <= k) k++;
+        ranks.push_back(k);
+        taken.insert(std::upper_bound(taken.begin(), taken.end(), k), k);
+    }
+
+    auto removed = scratch_vec<int>();
+    if (ranks.empty()) return removed;
+    auto by_gain = [](const Cand& a, const Cand& b){ return a.gain > b.gain; };
+    const size_t deepest = taken.back();
+    std::nth_element(scored.begin(), scored.begin() + deepest, scored.end(), by_gain);
+    std::sort(scored.begin(), scored.begin() + deepest, by_gain);
+    for (size_t k : ranks) removed.push_back(scored[k].node);
+    return removed;
+}
+
+// Employee::index of a uniformly random routed employee, -1 if none. Draws
+// indices until one is routed (expected 1 / share routed draws); after a run
+// of misses, e.g. early on with few routed, it falls back to listing them.
+static int random_routed(const SolutionState& state, std::mt19937& rng) {
+    const int n = (int)state.routed.size();
+    if (n == 0) return -1;
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    for (int tries = 0; tries < 64; tries++) {
+        const int e = pick(rng);
+        if (state.routed[e] && state.at[e].vi >= 0) return e;
+    }
+    auto routed = scratch_vec<int>();
+    for (int e = 0; e < n; e++)
+        if (state.routed[e] && state.at[e].vi >= 0) routed.push_back(e);
+    if (routed.empty()) return -1;
+    std::uniform_int_distribution<int> pick_routed(0, (int)routed.size() - 1);
+    return routed[pick_routed(rng)];
+}
+
+// A uniformly random non-empty trip; nullptr when nothing is routed. The trip
+// of a random passenger, kept with probability 1 / its passengers so every trip
+// is equally likely: expected draws are bounded by the seats per trip, whatever
+// the number of trips.
+static const Route* random_nonempty_trip(const SolutionState& state,
+                                         const std::vector<Vehicle>& vehicles, std::mt19937& rng) {
+    std::uniform_real_distribution<double> U01(0.0, 1.0);
+    for (;;) {
+        const int e = random_routed(state, rng);
+        if (e < 0) return nullptr;
+        const Route& r = vehicles[state.at[e].vi].routes[state.at[e].ri];
+        if (U01(rng) * (double)(r.stops.size() - 2) < 1.0) return &r;
+    }
+}
+
+// Route removal: empties a whole trip so repair has to redistribute its passengers,
+// which is the only way the search drops a trip. `smallest` takes the trip with the
+// fewest passengers (a random one among ties), otherwise a random one. Ignores q.
+static ScratchVec<int> destroy_route(const ALNSContext& ctx,
+                                     const SolutionState& state,
+                                     const std::vector<Vehicle>& vehicles,
+                                     bool smallest) {
+    const Route* target = nullptr;
+    if (smallest) {
+        // Lowest non-empty size bucket of the state, no scan over the trips.
+        for (const auto& bucket : state.trips_by_size) {
+            if (bucket.empty()) continue;
+            const TripRef t = bucket[ctx.rng() % bucket.size()];
+            target = &vehicles[t.vi].routes[t.ri];
+            break;
+        }
+    } else {
+        target = random_nonempty_trip(state, vehicles, ctx.rng);
+    }
+    auto removed = scratch_vec<int>();
+    if (!target) return removed;
+
+    for (const auto& s : target->stops)
+        if (s.is_pickup()) removed.push_back(s.node);
+    return removed;
+}
+
+// Cluster removal: a random routed employee and its q-1 nearest pickups (grid lookup).
+// Unrouted neighbours may be included; apply_removals skips them and repair retries them.
+static ScratchVec<int> destroy_cluster(const ALNSContext& ctx,
+                                       const SolutionState& state,
+                                       const std::vector<Vehicle>&,
+                                       int q) {
+    const int seed = random_routed(state, ctx.rng);
+    if (seed < 0) return scratch_vec<int>();
+    const InstanceStore& st = ctx.store;
+    auto removed = ctx.nb.grid.nearest({st.lat[seed], st.lng[seed]}, q, &iteration_arena());
+    for (int& i : removed) i = ctx.nb.grid_ids[i];
+    return removed;
+}
+
+// Time-band removal: up to q employees whose due_time lies within time_band_min/2 of a
+// random routed employee's, taken outwards from the seed in due order.
+static ScratchVec<int> destroy_time_band(const ALNSContext& ctx,
+                                         const SolutionState& state,
+                                         const std::vector<Vehicle>&,
+                                         int q) {
+    auto removed = scratch_vec<int>();
+    const int seed = random_routed(state, ctx.rng);
+    if (seed < 0) return removed;
+
+    const std::vector<int>& by_due = ctx.nb.by_due;
+    const std::vector<int>& due = ctx.store.due;
+    const int t = due[seed];
+    const int half = std::max(0, ctx.cfg.time_band_min / 2);
+
+    auto pos = std::lower_bound(by_due.begin(), by_due.end(), t,
+                                [&](int i, int d){ return due[i] < d; });
+    int hi = (int)(pos - by_due.begin());
+    int lo = hi - 1;
+
+    while ((int)removed.size() < q) {
+        const bool hi_ok = hi < (int)by_due.size() && due[by_due[hi]] - t <= half;
+        const bool lo_ok = lo >= 0 && t - due[by_due[lo]] <= half;
+        if (!hi_ok && !lo_ok) break;
+        if (hi_ok && (!lo_ok || due[by_due[hi]] - t <= t - due[by_due[lo]]))
+            removed.push_back(by_due[hi++]);
+        else
+            removed.push_back(by_due[lo--]);
+    }
+    return removed;
+}
+
+NeighbourIndex build_neighbour_index(const InstanceStore& store) {
+    NeighbourIndex nb;
+    nb.grid_ids = store.members;
+    std::vector<Location> pts;
+    pts.reserve(store.members.size());
+    for (int i : store.members) pts.push_back({store.lat[i], store.lng[i]});
+    nb.grid.build(pts);
+
+    nb.by_due = store.members;
+    std::stable_sort(nb.by_due.begin(), nb.by_due.end(),
+                     [&](int a, int b){ return store.due[a] < store.due[b]; });
+    return nb;
+}
+
+// Saving of dropping stop i from r: its detour, its own lateness, ride and wait.
+// Neighbour re-timing is ignored, so this is an estimate but needs no simulation.
+static double estimate_removal_gain(const Route& r, size_t i, const Vehicle& v,
+                                    const EmployeeIndex& idx, const ObjectiveWeights& w) {
+    const Stop& s = r.stops[i];
+    const Location& prev = r.stops[i - 1].loc();
+    const Location& next = r.stops[i + 1].loc();
+    const double detour = get_dist(prev, s.loc()) + get_dist(s.loc(), next) - get_dist(prev, next);
+    const int office_arrival = r.stops.back().arrival_time;
+
+    double late = 0.0;
+    auto it = idx.find(s.emp_id());
+    if (it != idx.end()) late = lateness_penalty(*it->second, office_arrival);
+
+    return w.cost * (detour * v.cost_per_km + late)
+         + w.ride * (office_arrival - s.departure_time)
+         + w.wait * (s.begin_service - s.arrival_time);
+}
+
+int refresh_removal_gains(std::vector<Vehicle>& vehicles, const EmployeeIndex& idx,
+                          const ObjectiveWeights& w) {
+    ArenaScope scratch;
+    struct Stale { int vi, ri; };
+    auto stale = scratch_vec<Stale>();
+    for (int vi = 0; vi < (int)vehicles.size(); vi++)
+        for (int ri = 0; ri < (int)vehicles[vi].routes.size(); ri++)
+            if (vehicles[vi].routes[ri].removal_gain_stale) stale.push_back({vi, ri});
+
+    // Each trip is priced on its own; a large batch (the first call, or after a
+    // big repair) is spread over the task pool.
+    task_pool().parallel_for((int)stale.size(), 16, [&](int k) {
+        const Vehicle& v = vehicles[stale[k].vi];
+        Route& r = vehicles[stale[k].vi].routes[stale[k].ri];
+        r.removal_gain.assign(r.stops.size(), 0.0);
+        for (size_t i = 1; i + 1 < r.stops.size(); i++) {
+            if (r.stops[i].is_pickup()) r.removal_gain[i] = estimate_removal_gain(r, i, v, idx, w);
+        }
+        r.removal_gain_stale = false;
+    });
+    return (int)stale.size();
+}
+
+
+// ------------------------------------------------------------
+// Apply removal to the real solution
+// ------------------------------------------------------------
+void apply_removals(SolutionState& state,
+                    std::vector<Vehicle>& vehicles,
+                    const ScratchVec<int>& removed,
+                    const EmployeeIndex& idx,
+                    SolutionObjective& obj) {
+    // mark unrouted, remembering where each one sat
+    struct Hit { Placement at; int node; };
+    auto hits = scratch_vec<Hit>();
+    hits.reserve(removed.size());
+    for (int e : removed) {
+        if (!state.routed[e]) continue;
+        state.routed[e] = 0;
+        obj.unrouted++;
+        if (state.at[e].vi >= 0) hits.push_back({state.at[e], e});
+        state.at[e] = Placement();
+    }
+
+    // Erase trip by trip, back to front so earlier positions stay valid;
+    // only changed routes are re-priced.
+    std::sort(hits.begin(), hits.end(), [](const Hit& x, const Hit& y) {
+        if (x.at.vi != y.at.vi) return x.at.vi < y.at.vi;
+        if (x.at.ri != y.at.ri) return x.at.ri < y.at.ri;
+        return x.at.pos > y.at.pos;
+    });
+    for (size_t i = 0; i < hits.size();) {
+        const int vi = hits[i].at.vi, ri = hits[i].at.ri;
+        Vehicle& v = vehicles[vi];
+        Route& r = v.routes[ri];
+        const RouteObjective before = route_objective(r);
+        const uint64_t key_before = trip_key(r, vi, ri);
+        bool changed = false;
+        for (; i < hits.size() && hits[i].at.vi == vi && hits[i].at.ri == ri; i++)
+            if (HOOK_remove_employee_from_route(r, hits[i].node, hits[i].at.pos)) changed = true;
+        if (!changed) continue;
+
+        // recompute route
+        HOOK_simulate_route(r, v, idx);
+        obj.replace(before, route_objective(r));
+        obj.hash ^= key_before ^ trip_key(r, vi, ri);
+        state.place_trip(r, vi, ri);
+        v.total_cost = vehicle_cost(v);
+    }
+}
+
+
+// ------------------------------------------------------------
+// Repair operators
+// ------------------------------------------------------------
+// Objective delta of making `cand` trip ri of v. If the longer trip runs into the
+// next one, later trips are pushed back on a scratch copy and their changes count too.
+// Returns false when the push makes a later trip infeasible.
+static bool trip_insertion_delta(const Vehicle& v, int ri, const Route& cand,
+                                 const EmployeeIndex& idx, const ObjectiveWeights& w,
+                                 double& delta) {
+    delta = route_score(cand, w) - route_score(v.routes[ri], w);
+    if (chain_has_slack(v, (size_t)ri, cand.stops.back().departure_time)) return true;
+
+    static thread_local Vehicle shifted;   // copy-assigned: keeps its trip buffer between calls
+    shifted = v;
+    shifted.routes[ri] = cand;
+    if (!rechain_trips(shifted, (size_t)ri, idx)) return false;
+    for (size_t t = (size_t)ri + 1; t < v.routes.size(); t++) {
+        delta += route_score(shifted.routes[t], w) - route_score(v.routes[t], w);
+    }
+    return true;
+}
+
+// Best insertion of `emp` into trip slot ri of v. Slot routes.size() is a new trip
+// appended after the last one, offered only when the vehicle has no empty trip at
+// its end already; this is how repair opens extra trips. `prices` are the batch
+// prices of emp in trip ri when a block pass already computed them.
+static bool evaluate_trip_slot(const Vehicle& v, int ri, const Employee& emp,
+                               const EmployeeIndex& idx, const ObjectiveWeights& w,
+                               Route& cand, double& delta,
+                               double blink_rate = 0.0, std::mt19937* rng = nullptr,
+                               const double* prices = nullptr) {
+    const int n = (int)v.routes.size();
+    if (ri == n) {
+        if (n > 0 && v.routes.back().stops.size() <= 2) return false;
+        cand = make_next_trip(v);
+        if (!HOOK_best_insert(cand, v, emp, idx, w, blink_rate, rng)) return false;
+        delta = route_score(cand, w);
+        return true;
+    }
+    // Reject on the compatibility bits before copying the trip.
+    if (!check_compatibility(v, emp, v.routes[ri])) return false;
+    cand = v.routes[ri];
+    if (prices) {
+        if (!best_insert_priced(cand, v, emp, idx, w, prices, blink_rate, rng)) return false;
+    } else if (!HOOK_best_insert(cand, v, emp, idx, w, blink_rate, rng)) {
+        return false;
+    }
+    return trip_insertion_delta(v, ri, cand, idx, w, delta);
+}
+
+// Replace trip ri of v with `cand` (or append it when ri == routes.size()),
+// re-chain later trips and keep `obj` in sync. Re-chaining only moves times, so
+// only trip ri changes the fingerprint.
+static void commit_trip(Vehicle& v, int vi, int ri, Route&& cand, const EmployeeIndex& idx,
+                        SolutionObjective& obj) {
+    if (ri == (int)v.routes.size()) v.routes.emplace_back();
+    else obj.hash ^= trip_key(v.routes[ri], vi, ri);
+    for (size_t t = (size_t)ri; t < v.routes.size(); t++) obj.remove(route_objective(v.routes[t]));
+    v.routes[ri] = std::move(cand);
+    obj.hash ^= trip_key(v.routes[ri], vi, ri);
+    rechain_trips(v, (size_t)ri, idx);
+    for (size_t t = (size_t)ri; t < v.routes.size(); t++) obj.add(route_objective(v.routes[t]));
+    v.total_cost = vehicle_cost(v);
+}
+
+// Lower bound on evaluate_trip_slot()'s delta, valid because get_dist is a metric:
+//  - detour: any leg (a,b) of the trip has d(a,e) + d(e,b) - d(a,b) >= 2*d(e, nearest stop)
+//    - max_edge, and d(e, nearest stop) >= d(e, centroid) - radius;
+//  - lateness and the new passenger's ride only add cost; pushing stops later can
+//    only save what the trip and the later trips of the vehicle currently wait,
+//    once as wait and once per passenger as ride.
+// `tight` pays O(k) distances for the exact nearest stop.
+static double insertion_lower_bound(const Vehicle& v, int ri, const Employee& emp,
+                                    const ObjectiveWeights& w, bool tight) {
+    const double per_km = w.cost * v.cost_per_km;
+    if (ri == (int)v.routes.size()) {
+        // make_next_trip() always leaves from the office.
+        return per_km * 2.0 * get_dist(OFFICE, emp.pickup);
+    }
+
+    const Route& r = v.routes[ri];
+    double nearest = get_dist(emp.pickup, r.centroid) - r.radius_km;
+    if (tight) {
+        // The exact distance to the nearest stop is never below the centroid bound.
+        double exact = std::numeric_limits<double>::infinity();
+        for (const auto& s : r.stops) exact = std::min(exact, get_dist(emp.pickup, s.loc()));
+        nearest = std::max(nearest, exact);
+    }
+    const double detour = std::max(0.0, 2.0 * nearest - r.max_edge_km);
+
+    double slack = 0.0;
+    for (size_t t = (size_t)ri; t < v.routes.size(); t++) {
+        const Route& rt = v.routes[t];
+        slack += (w.wait + w.ride * rt.current_capacity) * rt.wait_minutes;
+    }
+    return per_km * detour - slack;
+}
+
+// ------------------------------------------------------------
+// Block prices of a repair's pending employees
+// ------------------------------------------------------------
+// Per trip: 0 = not priced, 1 = being priced, 2 = ready; `cost` holds one row
+// of n prices per block column.
+struct InsertionPrices::Trip {
+    std::atomic<int> ready{0};
+    int n = 0;
+    double* cost = nullptr;
+};
+
+InsertionPrices::InsertionPrices(const std::vector<Vehicle>& vehicles, const SolutionState& state,
+                                 const InstanceStore& store, const ScratchVec<int>& emps,
+                                 const ObjectiveWeights& w)
+    : vehicles_(vehicles), state_(state), w_(w),
+      emps_(scratch_vec<const Employee*>()),
+      trips_(scratch_vec<Trip*>(vehicles.size())),
+      count_(scratch_vec<int>(vehicles.size())) {
+    for (int e : emps) emps_.push_back(&store.employee(e));
+    for (int vi = 0; vi < (int)vehicles.size(); vi++) layout(vi);
+}
+
+// Fresh, unpriced rows for the current trips of vehicle vi (the old ones stay
+// in the arena until the scope closes).
+void InsertionPrices::layout(int vi) {
+    const auto& routes = vehicles_[vi].routes;
+    const int count = (int)routes.size();
+    IterationArena& arena = iteration_arena();
+    Trip* trips = static_cast<Trip*>(arena.allocate(count * sizeof(Trip), alignof(Trip)));
+    for (int ri = 0; ri < count; ri++) {
+        Trip* t = new (trips + ri) Trip();
+        t->n = (int)routes[ri].stops.size();
+        t->cost = static_cast<double*>(arena.allocate(emps_.size() * t->n * sizeof(double), alignof(double)));
+    }
+    trips_[vi] = trips;
+    count_[vi] = count;
+}
+
+int InsertionPrices::column(int emp_index) const {
+    for (int c = 0; c < (int)emps_.size(); c++)
+        if (emps_[c] && emps_[c]->index == emp_index) return c;
+    return -1;
+}
+
+const double* InsertionPrices::row(int vi, int ri, int col) {
+    if (ri >= count_[vi]) return nullptr;
+    Trip& t = trips_[vi][ri];
+    if (t.n != (int)vehicles_[vi].routes[ri].stops.size()) return nullptr;   // changed without placed()
+    int expected = 0;
+    if (t.ready.load(std::memory_order_acquire) != 2) {
+        if (t.ready.compare_exchange_strong(expected, 1, std::memory_order_acq_rel)) {
+            // One pass for every pending employee the trip's pairing row allows.
+            const Vehicle& v = vehicles_[vi];
+            const Route& r = v.routes[ri];
+            const uint64_t* mask = state_.trip_mask(r, vi, ri);
+            static thread_local std::vector<const Employee*> block;
+            block.assign(emps_.begin(), emps_.end());
+            for (auto& e : block)
+                if (e && !check_compatibility(v, *e, r, mask)) e = nullptr;
+            static thread_local TripSoA soa;
+            build_trip_soa(r, v, soa);
+            price_insertions_block(soa, block.data(), (int)block.size(), w_, t.cost);
+            t.ready.store(2, std::memory_order_release);
+        } else {
+            while (t.ready.load(std::memory_order_acquire) != 2) std::this_thread::yield();
+        }
+    }
+    return t.cost + (size_t)col * t.n;
+}
+
+void InsertionPrices::placed(int emp_index, int vi) {
+    const int col = column(emp_index);
+    if (col >= 0) emps_[col] = nullptr;
+    layout(vi);
+}
+
+bool find_best_insertion(const std::vector<Vehicle>& vehicles,
+                         const Employee& emp,
+                         const EmployeeIndex& idx,
+                         const ObjectiveWeights& w,
+                         InsertionChoice& best,
+                         double blink_rate,
+                         std::mt19937* rng,
+                         double* second,
+                         const SolutionState* state,
+                         InsertionPrices* prices) {
+    // Best insertion across all trips, ranked by objective delta. Trip slots are
+    // visited in order of a lower bound and the scan stops once the bound exceeds
+    // the incumbent (or the runner-up when `second` is wanted). Ties go to the
+    // lowest (vehicle, trip), so the pick matches a full scan in fleet order.
+    // With `state`, each trip's pairing check is one bit of its AND row; with
+    // `prices`, existing trips are priced from the repair's block passes.
+    best.vi = best.ri = -1;
+    best.delta = std::numeric_limits<double>::infinity();
+    if (second) *second = std::numeric_limits<double>::infinity();
+
+    ArenaScope scratch;
+    struct Slot { double lb; int vi, ri; };
+    auto slots = scratch_vec<Slot>();
+    for (int vi = 0; vi < (int)vehicles.size(); vi++) {
+        const auto& v = vehicles[vi];
+        if (!compat_eligible(v.category, emp)) continue;
+        for (int ri = 0; ri <= (int)v.routes.size(); ri++) {
+            if (ri < (int)v.routes.size()) {
+                const Route& r = v.routes[ri];
+                const uint64_t* mask = state ? state->trip_mask(r, vi, ri) : nullptr;
+                if (!check_compatibility(v, emp, r, mask)) continue;
+            }
+            slots.push_back({insertion_lower_bound(v, ri, emp, w, false), vi, ri});
+        }
+    }
+    std::sort(slots.begin(), slots.end(), [](const Slot& a, const Slot& b) {
+        if (a.lb != b.lb) return a.lb < b.lb;
+        return a.vi != b.vi ? a.vi < b.vi : a.ri < b.ri;
+    });
+
+    const int col = prices ? prices->column(emp.index) : -1;
+    Route cand;
+    for (const Slot& sl : slots) {
+        const double cutoff = second ? *second : best.delta;
+        if (sl.lb > cutoff) break;
+        const auto& v = vehicles[sl.vi];
+        const bool existing = sl.ri < (int)v.routes.size();
+        if (existing && insertion_lower_bound(v, sl.ri, emp, w, true) > cutoff) continue;
+
+        const double* row = existing && col >= 0 ? prices->row(sl.vi, sl.ri, col) : nullptr;
+        double delta;
+        if (!evaluate_trip_slot(v, sl.ri, emp, idx, w, cand, delta, blink_rate, rng, row)) continue;
+        const bool better = delta < best.delta ||
+            (delta == best.delta && (sl.vi < best.vi || (sl.vi == best.vi && sl.ri < best.ri)));
+        if (better) {
+            if (second) *second = best.delta;
+            best.delta = delta;
+            best.vi = sl.vi;
+            best.ri = sl.ri;
+            best.route = std::move(cand);
+        } else if (second && delta < *second) {
+            *second = delta;
+        }
+    }
+    return best.vi != -1;
+}
+
+void commit_insertion(std::vector<Vehicle>& vehicles, InsertionChoice&& choice,
+                      const EmployeeIndex& idx, SolutionObjective& obj) {
+    commit_trip(vehicles[choice.vi], choice.vi, choice.ri, std::move(choice.route), idx, obj);
+}
+
+bool try_insert_anywhere(SolutionState& state,
+                         std::vector<Vehicle>& vehicles,
+                         const Employee& emp,
+                         const EmployeeIndex& idx,
+                         const ObjectiveWeights& w,
+                         SolutionObjective& obj,
+                         double blink_rate,
+                         std::mt19937* rng,
+                         InsertionPrices* prices) {
+    InsertionChoice best;
+    if (!find_best_insertion(vehicles, emp, idx, w, best, blink_rate, rng, nullptr, &state, prices)) return false;
+    const int vi = best.vi, ri = best.ri;
+    commit_insertion(vehicles, std::move(best), idx, obj);
+
+    // mark routed
+    if (!state.routed[emp.index]) obj.unrouted--;
+    state.routed[emp.index] = 1;
+    state.place_trip(vehicles[vi].routes[ri], vi, ri);
+    if (prices) prices->placed(emp.index, vi);
+    return true;
+}
+
+static void repair_greedy(const InstanceStore& store,
+                          SolutionState& state,
+                          std::vector<Vehicle>& vehicles,
+                          const ScratchVec<int>& removed,
+                          const EmployeeIndex& idx,
+                          const ObjectiveWeights& w,
+                          SolutionObjective& obj) {
+    // Insert in given order
+    for (int e : removed) (void)try_insert_anywhere(state, vehicles, store.employee(e), idx, w, obj);
+}
+
+// Regret-2: insert hardest first
+static void repair_regret2(const InstanceStore& store,
+                           SolutionState& state,
+                           std::vector<Vehicle>& vehicles,
+                           const ScratchVec<int>& removed,
+                           const EmployeeIndex& idx,
+                           const ObjectiveWeights& w,
+                           SolutionObjective& obj) {
+    auto remaining = scratch_vec<int>();
+    for (int e : removed)
+        if (std::find(remaining.begin(), remaining.end(), e) == remaining.end()) remaining.push_back(e);
+
+    auto regrets = scratch_vec<double>(remaining.size());
+    InsertionPrices prices(vehicles, state, store, remaining, w);
+    while (!remaining.empty()) {
+        int best_k = -1;
+        double best_regret = -1.0;
+
+        // For each remaining employee, compute best and 2nd best insertion costs.
+        // The scans only read the solution, so they run on the task pool; the
+        // pick below goes in index order as before.
+        task_pool().parallel_for((int)remaining.size(), 1, [&](int k) {
+            InsertionChoice choice;
+            double second;
+            find_best_insertion(vehicles, store.employee(remaining[k]), idx, w, choice, 0.0, nullptr, &second,
+                                &state, &prices);
+            const double best = choice.delta;
+            if (!std::isfinite(best)) regrets[k] = -1.0;   // cannot insert anywhere
+            else regrets[k] = std::isfinite(second) ? (second - best) : 1e6; // if only one option, huge regret
+        });
+
+        for (int k = 0; k < (int)remaining.size(); k++) {
+            const double regret = regrets[k];
+            if (regret < 0.0) continue;
+            if (regret > best_regret) {
+                best_regret = regret;
+                best_k = k;
+            }
+        }
+
+        if (best_k < 0) {
+            // cannot insert any remaining -> stop
+            break;
+        }
+
+        (void)try_insert_anywhere(state, vehicles, store.employee(remaining[best_k]), idx, w, obj, 0.0, nullptr,
+                                  &prices);
+        remaining[best_k] = remaining.back();
+        remaining.pop_back();
+    }
+}
+
+// ------------------------------------------------------------
+// SISR: slack induction by string removals
+// ------------------------------------------------------------
+// Ruin removes strings of consecutive pickups from up to k_s trips found around a
+// seed employee; recreate re-inserts with blinks. Both avoid regret scans, so an
+// iteration is cheap and the SA loop can run many more of them.
+
+// Removes a plain string of l consecutive pickups containing stop p (1-based in stops).
+static void sisr_string(const Route& r, int p, int l, std::mt19937& rng,
+                        ScratchVec<int>& out) {
+    const int card = (int)r.stops.size() - 2;
+    std::uniform_int_distribution<int> start(std::max(1, p - l + 1), std::min(p, card - l + 1));
+    const int a = start(rng);
+    for (int i = a; i < a + l; i++) out.push_back(r.stops[i].node);
+}
+
+// Split string: a window of l+m pickups around p, keeping m consecutive ones.
+static void sisr_split_string(const Route& r, int p, int l, double depth, std::mt19937& rng,
+                              ScratchVec<int>& out) {
+    const int card = (int)r.stops.size() - 2;
+    std::uniform_real_distribution<double> U01(0.0, 1.0);
+    int m = 1;
+    while (l + m < card && U01(rng) > depth) m++;
+
+    const int len = l + m;
+    std::uniform_int_distribution<int> start(std::max(1, p - len + 1), std::min(p, card - len + 1));
+    const int a = start(rng);
+    std::uniform_int_distribution<int> keep(0, l);
+    const int k = a + keep(rng);
+    for (int i = a; i < a + len; i++) {
+        if (i >= k && i < k + m) continue;
+        out.push_back(r.stops[i].node);
+    }
+}
+
+static ScratchVec<int> sisr_ruin(const ALNSContext& ctx, const SolutionState& state,
+                                 const std::vector<Vehicle>& vehicles) {
+    const SISRConfig& sc = ctx.cfg.sisr;
+    auto removed = scratch_vec<int>();
+    auto where = scratch_vec<const Route*>(ctx.store.n);     // by Employee::index
+    int n_trips = 0, n_routed = 0;
+    for (const auto& v : vehicles) {
+        for (const auto& r : v.routes) {
+            if (r.stops.size() <= 2) continue;
+            n_trips++;
+            for (const auto& s : r.stops)
+                if (s.is_pickup()) { where[s.node] = &r; n_routed++; }
+        }
+    }
+    if (n_routed == 0) return removed;
+
+    std::uniform_real_distribution<double> U01(0.0, 1.0);
+    const double avg_card = (double)n_routed / n_trips;
+    const double ls_max = std::min((double)sc.max_string_len, avg_card);
+    const double ks_max = 4.0 * sc.avg_removed / (1.0 + ls_max) - 1.0;
+    const int ks = std::max(1, (int)std::floor(1.0 + U01(ctx.rng) * ks_max));
+
+    const int seed = random_routed(state, ctx.rng);
+    if (seed < 0) return removed;
+    const int k = std::min((int)ctx.store.members.size(), std::max(50, (int)(8 * sc.avg_removed)));
+    const auto adj = ctx.nb.grid.nearest({ctx.store.lat[seed], ctx.store.lng[seed]}, k, &iteration_arena());
+
+    auto ruined = scratch_vec<const Route*>();              // at most ks trips
+    for (int g : adj) {
+        const int i = ctx.nb.grid_ids[g];
+        if ((int)ruined.size() >= ks) break;
+        if (!where[i] || std::find(ruined.begin(), ruined.end(), where[i]) != ruined.end()) continue;
+        const Route& r = *where[i];
+
+        const int card = (int)r.stops.size() - 2;
+        const double l_max = std::min((double)card, ls_max);
+        const int l = std::min(card, std::max(1, (int)std::floor(1.0 + U01(ctx.rng) * l_max)));
+        int p = 1;
+        while (r.stops[p].node != i) p++;
+
+        if (l < card && U01(ctx.rng) < sc.split_rate) sisr_split_string(r, p, l, sc.split_depth, ctx.rng, removed);
+        else sisr_string(r, p, l, ctx.rng, removed);
+        ruined.push_back(&r);
+    }
+    return removed;
+}
+
+// Recreate order is drawn with the paper's weights: random 4, tightest due 4,
+// farthest from the office 2, closest 1 (due_time stands in for demand).
+static void sisr_recreate(const ALNSContext& ctx, SolutionState& state,
+                          std::vector<Vehicle>& vehicles, ScratchVec<int>& removed,
+                          SolutionObjective& obj) {
+    // 11 equally likely tickets split 4/4/2/1 (a discrete_distribution would
+    // allocate its table on every call).
+    const int ticket = std::uniform_int_distribution<int>(0, 10)(ctx.rng);
+    const int order = ticket < 4 ? 0 : ticket < 8 ? 1 : ticket < 10 ? 2 : 3;
+    auto key = [&](int e) { return &ctx.store.employee(e); };
+    switch (order) {
+    case 0:
+        std::shuffle(removed.begin(), removed.end(), ctx.rng);
+        break;
+    case 1:
+        std::sort(removed.begin(), removed.end(), [&](int a, int b) {
+            return key(a)->due_time < key(b)->due_time;
+        });
+        break;
+    case 2:
+        std::sort(removed.begin(), removed.end(), [&](int a, int b) {
+            return get_dist(key(a)->pickup, OFFICE) > get_dist(key(b)->pickup, OFFICE);
+        });
+        break;
+    default:
+        std::sort(removed.begin(), removed.end(), [&](int a, int b) {
+            return get_dist(key(a)->pickup, OFFICE) < get_dist(key(b)->pickup, OFFICE);
+        });
+        break;
+    }
+
+    InsertionPrices prices(vehicles, state, ctx.store, removed, ctx.w);
+    for (int e : removed) {
+        (void)try_insert_anywhere(state, vehicles, *key(e), ctx.idx, ctx.w, obj,
+                                  ctx.cfg.sisr.blink_rate, &ctx.rng, &prices);
+    }
+}
+
+void two_opt_vehicle(Vehicle& vehicle, bool debug) {
+    HOOK_two_opt_vehicle(vehicle, debug);
+}
+
+
+// ------------------------------------------------------------
+// Operator registry
+// ------------------------------------------------------------
+void OperatorRegistry::add_destroy(const std::string& name, DestroyFn fn) {
+    DestroyOperator op;
+    op.name = name;
+    op.fn = std::move(fn);
+    destroy.push_back(std::move(op));
+}
+
+void OperatorRegistry::add_repair(const std::string& name, RepairFn fn) {
+    RepairOperator op;
+    op.name = name;
+    op.fn = std::move(fn);
+    repair.push_back(std::move(op));
+}
+
+template <class Op>
+static int pick_weighted(const std::vector<Op>& ops, std::mt19937& rng) {
+    double sum = 0.0;
+    for (const auto& op : ops) sum += op.weight;
+    std::uniform_real_distribution<double> U(0.0, sum);
+    double r = U(rng);
+    for (int i = 0; i < (int)ops.size(); i++) {
+        r -= ops[i].weight;
+        if (r <= 0.0) return i;
+    }
+    return (int)ops.size() - 1;
+}
+
+int OperatorRegistry::pick_destroy(std::mt19937& rng) const { return pick_weighted(destroy, rng); }
+int OperatorRegistry::pick_repair(std::mt19937& rng) const { return pick_weighted(repair, rng); }
+
+static void credit(ALNSOperator& op, IterationOutcome outcome, double sec, const ALNSConfig& cfg) {
+    op.segment_uses++;
+    op.segment_seconds += sec;
+    op.total.uses++;
+    op.total.seconds += sec;
+
+    switch (outcome) {
+    case IterationOutcome::NEW_BEST:
+        op.segment_score += cfg.sigma1;
+        op.total.new_best++;
+        op.total.improved++;
+        op.total.accepted++;
+        break;
+    case IterationOutcome::IMPROVED:
+        op.segment_score += cfg.sigma2;
+        op.total.improved++;
+        op.total.accepted++;
+        break;
+    case IterationOutcome::ACCEPTED:
+        op.segment_score += cfg.sigma3;
+        op.total.accepted++;
+        break;
+    case IterationOutcome::REJECTED:
+        break;
+    }
+}
+
+void OperatorRegistry::record(int d, int r, IterationOutcome outcome,
+                              double destroy_sec, double repair_sec, const ALNSConfig& cfg) {
+    credit(destroy[d], outcome, destroy_sec, cfg);
+    credit(repair[r], outcome, repair_sec, cfg);
+}
+
+template <class Op>
+static void update_segment(std::vector<Op>& ops, const ALNSConfig& cfg) {
+    // Average time per use over the operators that ran this segment; an operator
+    // twice as slow as average needs twice the score per use to keep its weight.
+    double sec = 0.0;
+    int uses = 0;
+    for (const auto& op : ops) { sec += op.segment_seconds; uses += op.segment_uses; }
+    const double avg_sec = uses > 0 ? sec / uses : 0.0;
+
+    for (auto& op : ops) {
+        if (op.segment_uses > 0) {
+            double reward = op.segment_score / op.segment_uses;
+            if (cfg.time_normalized && avg_sec > 0.0) {
+                const double per_use = op.segment_seconds / op.segment_uses;
+                reward /= std::max(per_use / avg_sec, 1e-3);
+            }
+            op.weight = (1.0 - cfg.reaction) * op.weight + cfg.reaction * reward;
+            op.weight = std::max(op.weight, cfg.min_weight);
+        }
+        op.segment_score = 0.0;
+        op.segment_seconds = 0.0;
+        op.segment_uses = 0;
+    }
+}
+
+void OperatorRegistry::end_segment(const ALNSConfig& cfg) {
+    update_segment(destroy, cfg);
+    update_segment(repair, cfg);
+}
+
+template <class Op>
+static void print_ops(const char* kind, const std::vector<Op>& ops) {
+    for (const auto& op : ops) {
+        const OperatorStats& s = op.total;
+        const double ms = s.uses > 0 ? 1000.0 * s.seconds / s.uses : 0.0;
+        std::printf("  %-8s %-11s w=%7.3f uses=%5d acc=%5d impr=%5d best=%4d ms/use=%.3f\n",
+                    kind, op.name.c_str(), op.weight, s.uses, s.accepted, s.improved,
+                    s.new_best, ms);
+    }
+}
+
+void OperatorRegistry::print_stats() const {
+    std::cout << "[ALNS] operator stats:\n";
+    print_ops("destroy", destroy);
+    print_ops("repair", repair);
+}
+
+void register_default_operators(OperatorRegistry& reg, const ALNSConfig& cfg) {
+    reg.add_destroy("random", destroy_random);
+    reg.add_destroy("shaw", destroy_shaw);
+    const double p = cfg.worst_randomness;
+    reg.add_destroy("worst", [p](const ALNSContext& ctx, const SolutionState&,
+                                 const std::vector<Vehicle>& vehs, int q) {
+        return destroy_worst(ctx, vehs, q, p);
+    });
+    reg.add_destroy("route_small", [](const ALNSContext& ctx, const SolutionState& st,
+                                      const std::vector<Vehicle>& vehs, int) {
+        return destroy_route(ctx, st, vehs, true);
+    });
+    reg.add_destroy("route_rand", [](const ALNSContext& ctx, const SolutionState& st,
+                                     const std::vector<Vehicle>& vehs, int) {
+        return destroy_route(ctx, st, vehs, false);
+    });
+    reg.add_destroy("cluster", destroy_cluster);
+    reg.add_destroy("time_band", destroy_time_band);
+
+    auto greedy = [](const ALNSContext& ctx, SolutionState& st, std::vector<Vehicle>& vehs,
+                     ScratchVec<int>& removed, SolutionObjective& obj) {
+        repair_greedy(ctx.store, st, vehs, removed, ctx.idx, ctx.w, obj);
+    };
+    auto regret2 = [](const ALNSContext& ctx, SolutionState& st, std::vector<Vehicle>& vehs,
+                      ScratchVec<int>& removed, SolutionObjective& obj) {
+        repair_regret2(ctx.store, st, vehs, removed, ctx.idx, ctx.w, obj);
+    };
+
+    // use_regret2 now only decides whether regret-2 is in the pool; the adaptive
+    // weights choose between the registered repairs.
+    if (cfg.use_regret2) reg.add_repair("regret2", regret2);
+    reg.add_repair("greedy", greedy);
+}
+
+void register_sisr_operators(OperatorRegistry& reg, const ALNSConfig& cfg) {
+    (void)cfg;
+    reg.add_destroy("sisr_ruin", [](const ALNSContext& ctx, const SolutionState& st,
+                                    const std::vector<Vehicle>& vehs, int) {
+        return sisr_ruin(ctx, st, vehs);
+    });
+    reg.add_repair("sisr_blink", sisr_recreate);
+}
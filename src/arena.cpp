@@ -0,0 +1,48 @@
+#include "arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+IterationArena::IterationArena(size_t block_bytes) : block_bytes_(block_bytes) {}
+
+IterationArena::~IterationArena() {
+    for (auto& b : blocks_) ::operator delete(b.data);
+}
+
+size_t IterationArena::reserved_bytes() const {
+    size_t total = 0;
+    for (const auto& b : blocks_) total += b.size;
+    return total;
+}
+
+void* IterationArena::do_allocate(size_t bytes, size_t align) {
+    for (;;) {
+        if (cur_ < blocks_.size()) {
+            Block& b = blocks_[cur_];
+            const uintptr_t base = reinterpret_cast<uintptr_t>(b.data);
+            const size_t at = (size_t)(((base + off_ + align - 1) & ~(uintptr_t)(align - 1)) - base);
+            if (at + bytes <= b.size) {
+                off_ = at + bytes;
+                size_t live = off_;
+                for (size_t i = 0; i < cur_; i++) live += blocks_[i].size;
+                high_water_ = std::max(high_water_, live);
+                return b.data + at;
+            }
+            if (cur_ + 1 < blocks_.size()) {      // reuse the next retained block
+                cur_++;
+                off_ = 0;
+                continue;
+            }
+        }
+        // Out of retained blocks: grow (this is the only path that hits the heap).
+        const size_t size = std::max(block_bytes_, bytes + align);
+        blocks_.push_back({static_cast<char*>(::operator new(size)), size});
+        cur_ = blocks_.size() - 1;
+        off_ = 0;
+    }
+}
+
+IterationArena& iteration_arena() {
+    static thread_local IterationArena arena;
+    return arena;
+}
@@ -0,0 +1,81 @@
+#include "compat.h"
+#include <algorithm>
+#include "config.h"
+#include "geo.h"
+#include "lateness.h"
+#include "route_eval.h"
+
+using namespace std;
+
+CompatBits g_compat;
+
+static bool category_allows(VehicleCat cat, const Employee& e) {
+    return e.veh_pref != PREMIUM || cat == PREMIUM;
+}
+
+// a picked up first, then b, at `speed`; both must reach the office in time.
+static bool pair_order_ok(const Employee& a, const Employee& b, double speed) {
+    const int dep_a = a.ready_time + SERVICE_PICKUP_MIN;
+    const int arr_b = dep_a + travel_minutes(get_dist(a.pickup, b.pickup), speed);
+    const int dep_b = max(arr_b, b.ready_time) + SERVICE_PICKUP_MIN;
+    const int end = dep_b + travel_minutes(get_dist(b.pickup, OFFICE), speed);
+    return end <= min(hard_due(a), hard_due(b));
+}
+
+void build_compat(const vector<Employee>& emps, const vector<Vehicle>& vehs) {
+    CompatBits& c = g_compat;
+    c.n = (int)emps.size();
+    c.words = (c.n + 63) / 64;
+    c.pair.assign((size_t)c.n * c.words, 0);
+    for (auto& e : c.eligible) e.assign(c.words, 0);
+
+    double top_speed = 0.0;
+    bool shared_cat[3] = {false, false, false};   // category has a vehicle with >= 2 seats
+    for (const auto& v : vehs) {
+        top_speed = max(top_speed, v.speed_kmh);
+        if (v.capacity >= 2) shared_cat[v.category] = true;
+    }
+
+    for (int i = 0; i < c.n; i++) {
+        for (int cat = 0; cat < 3; cat++)
+            if (category_allows((VehicleCat)cat, emps[i])) c.eligible[cat][i >> 6] |= 1ull << (i & 63);
+    }
+
+    for (int i = 0; i < c.n; i++) {
+        uint64_t* ri = c.pair.data() + (size_t)i * c.words;
+        ri[i >> 6] |= 1ull << (i & 63);
+        for (int j = i + 1; j < c.n; j++) {
+            bool seat = false;
+            for (int cat = 0; cat < 3 && !seat; cat++)
+                seat = shared_cat[cat] && category_allows((VehicleCat)cat, emps[i])
+                                       && category_allows((VehicleCat)cat, emps[j]);
+            if (!seat) continue;
+            if (!pair_order_ok(emps[i], emps[j], top_speed) && !pair_order_ok(emps[j], emps[i], top_speed)) continue;
+            ri[j >> 6] |= 1ull << (j & 63);
+            c.pair[(size_t)j * c.words + (i >> 6)] |= 1ull << (i & 63);
+        }
+    }
+}
+
+bool compat_eligible(VehicleCat cat, const Employee& e) {
+    if (e.index < 0 || e.index >= g_compat.n) return category_allows(cat, e);
+    return bit_test(g_compat.eligible[cat], e.index);
+}
+
+void build_trip_compat(const StopList& stops, uint64_t* mask) {
+    for (int w = 0; w < g_compat.words; w++) mask[w] = ~0ull;
+    for (const Stop& s : stops) {
+        if (!s.is_pickup() || s.node >= g_compat.n) continue;
+        const uint64_t* row = g_compat.row(s.node);
+        for (int w = 0; w < g_compat.words; w++) mask[w] &= row[w];
+    }
+}
+
+bool compat_with_trip(const StopList& stops, const Employee& e) {
+    if (g_compat.pair.empty() || e.index < 0 || e.index >= g_compat.n) return true;
+    for (const Stop& s : stops) {
+        if (!s.is_pickup() || s.node >= g_compat.n) continue;
+        if (!bit_test(g_compat.row(s.node), e.index)) return false;
+    }
+    return true;
+}
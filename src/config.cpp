@@ -5,6 +5,13 @@ double ALPHA2 = 0.0;
 double LAMBDA = 1.0;
 double MU = 1.0;
 
+int PRIORITY_MAX_DELAY[6] = {0, 0, 0, 0, 0, 0};
+double OBJ_COST_WEIGHT = 1.0;
+double OBJ_TIME_WEIGHT = 0.0;
+double TIME_VALUE_PER_MIN = 1.0;
+double LATENESS_PENALTY_PER_MIN = -1.0;
+double PRIORITY_LATE_WEIGHT[6] = {0.0, 5.0, 4.0, 3.0, 2.0, 1.0};
+
 const double INF = 1e9;
 const double PI  = 3.14159265358979323846;
 
@@ -0,0 +1,535 @@
+#include "decompose.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include "alns_operators.h"
+#include "config.h"
+#include "geo.h"
+#include "heuristic.h"
+#include "objective.h"
+#include "route_eval.h"
+#include "task_pool.h"
+#include "time_utils.h"
+
+using namespace std;
+
+// ------------------------------------------------------------
+// Partitioning
+// ------------------------------------------------------------
+static double bearing_from_office(const Location& p) {
+    return atan2(p.lat - OFFICE.lat, (p.lng - OFFICE.lng) * cos(OFFICE.lat * PI / 180.0));
+}
+
+// Sweep: employees by bearing around the office, cut into equal runs. The sweep
+// starts after the widest empty sector so no part straddles a dense area.
+static vector<vector<int>> sweep_parts(const vector<Employee>& emps, int parts) {
+    const int n = (int)emps.size();
+    vector<pair<double, int>> by_angle(n);
+    for (int i = 0; i < n; i++) by_angle[i] = {bearing_from_office(emps[i].pickup), i};
+    sort(by_angle.begin(), by_angle.end());
+
+    int start = 0;
+    double widest = -1.0;
+    for (int i = 0; i < n; i++) {
+        const double prev = by_angle[(i + n - 1) % n].first;
+        double gap = by_angle[i].first - prev;
+        if (gap <= 0.0) gap += 2.0 * PI;
+        if (gap > widest) { widest = gap; start = i; }
+    }
+
+    vector<vector<int>> out(parts);
+    for (int k = 0; k < n; k++) {
+        const int p = (int)((long long)k * parts / n);
+        out[p].push_back(by_angle[(start + k) % n].second);
+    }
+    return out;
+}
+
+// k-means on pickups (k-means++ seeding, Lloyd iterations) in a local planar frame.
+static vector<vector<int>> kmeans_parts(const vector<Employee>& emps, int parts, unsigned seed) {
+    const int n = (int)emps.size();
+    const double sx = cos(OFFICE.lat * PI / 180.0);
+    vector<double> x(n), y(n);
+    for (int i = 0; i < n; i++) { x[i] = emps[i].pickup.lng * sx; y[i] = emps[i].pickup.lat; }
+    auto d2 = [&](int i, double cx, double cy) { return (x[i] - cx) * (x[i] - cx) + (y[i] - cy) * (y[i] - cy); };
+
+    mt19937 rng(seed);
+    vector<double> cx, cy;
+    const int first = uniform_int_distribution<int>(0, n - 1)(rng);
+    cx.push_back(x[first]);
+    cy.push_back(y[first]);
+    vector<double> best(n, numeric_limits<double>::infinity());
+    while ((int)cx.size() < parts) {
+        for (int i = 0; i < n; i++) best[i] = min(best[i], d2(i, cx.back(), cy.back()));
+        discrete_distribution<int> pick(best.begin(), best.end());
+        const int c = pick(rng);
+        cx.push_back(x[c]);
+        cy.push_back(y[c]);
+    }
+
+    vector<int> label(n, 0);
+    for (int iter = 0; iter < 50; iter++) {
+        bool moved = false;
+        for (int i = 0; i < n; i++) {
+            int b = 0;
+            for (int c = 1; c < parts; c++)
+                if (d2(i, cx[c], cy[c]) < d2(i, cx[b], cy[b])) b = c;
+            if (b != label[i]) { label[i] = b; moved = true; }
+        }
+        vector<double> sx_(parts, 0.0), sy_(parts, 0.0);
+        vector<int> cnt(parts, 0);
+        for (int i = 0; i < n; i++) { sx_[label[i]] += x[i]; sy_[label[i]] += y[i]; cnt[label[i]]++; }
+        for (int c = 0; c < parts; c++)
+            if (cnt[c] > 0) { cx[c] = sx_[c] / cnt[c]; cy[c] = sy_[c] / cnt[c]; }
+        if (!moved && iter > 0) break;
+    }
+
+    vector<vector<int>> out(parts);
+    for (int i = 0; i < n; i++) out[label[i]].push_back(i);
+    out.erase(remove_if(out.begin(), out.end(), [](const vector<int>& p) { return p.empty(); }), out.end());
+    return out;
+}
+
+vector<vector<int>> partition_employees(const vector<Employee>& emps, int parts,
+                                        PartitionMethod method, unsigned seed) {
+    parts = max(1, min(parts, (int)emps.size()));
+    if (parts == 1) {
+        vector<vector<int>> one(1);
+        for (int i = 0; i < (int)emps.size(); i++) one[0].push_back(i);
+        return one;
+    }
+    return method == PARTITION_KMEANS ? kmeans_parts(emps, parts, seed) : sweep_parts(emps, parts);
+}
+
+static Location centroid_of(const vector<Employee>& emps, const vector<int>& part) {
+    Location c{0.0, 0.0};
+    for (int i : part) { c.lat += emps[i].pickup.lat; c.lng += emps[i].pickup.lng; }
+    c.lat /= part.size();
+    c.lng /= part.size();
+    return c;
+}
+
+// Seats a rider effectively takes: sharing limits leave the rest of the trip empty.
+static double seat_demand(const Employee& e, double avg_capacity) {
+    switch (e.share_pref) {
+        case SINGLE: return max(1.0, avg_capacity);
+        case DOUBLE: return max(1.0, avg_capacity / 2.0);
+        case TRIPLE: return max(1.0, avg_capacity / 3.0);
+        default: return 1.0;
+    }
+}
+
+// Vehicles per part, proportional to the seats each part needs. Premium seats
+// are shared out first, by each part's premium-only demand; then every part
+// gets at least one vehicle and the rest top parts up towards their seat quota.
+// Within each rule a vehicle joins the nearest eligible part (by depot).
+static vector<vector<int>> allocate_vehicles(const vector<Employee>& emps, const vector<Vehicle>& vehs,
+                                             const vector<vector<int>>& parts,
+                                             const vector<Location>& centroids) {
+    const int k = (int)parts.size();
+    double seats_total = 0.0, premium_total = 0.0;
+    for (const auto& v : vehs) {
+        seats_total += v.capacity;
+        if (v.category == PREMIUM) premium_total += v.capacity;
+    }
+
+    const double avg_capacity = seats_total / max<size_t>(1, vehs.size());
+    vector<double> need(k, 0.0), premium_need(k, 0.0);
+    double need_total = 0.0, premium_need_total = 0.0;
+    for (int p = 0; p < k; p++) {
+        for (int i : parts[p]) {
+            const double d = seat_demand(emps[i], avg_capacity);
+            need[p] += d;
+            if (emps[i].veh_pref == PREMIUM) premium_need[p] += d;
+        }
+        need_total += need[p];
+        premium_need_total += premium_need[p];
+    }
+    vector<double> quota(k), seats(k, 0.0), premium_quota(k, 0.0), premium_seats(k, 0.0);
+    for (int p = 0; p < k; p++) {
+        quota[p] = seats_total * need[p] / need_total;
+        if (premium_need_total > 0.0) premium_quota[p] = premium_total * premium_need[p] / premium_need_total;
+    }
+
+    vector<int> order(vehs.size());
+    for (int i = 0; i < (int)order.size(); i++) order[i] = i;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        if ((vehs[a].category == PREMIUM) != (vehs[b].category == PREMIUM)) return vehs[a].category == PREMIUM;
+        return vehs[a].capacity > vehs[b].capacity;
+    });
+
+    vector<vector<int>> out(k);
+    for (int vi : order) {
+        const Vehicle& v = vehs[vi];
+        vector<int> cands;
+        if (v.category == PREMIUM)
+            for (int p = 0; p < k; p++) if (premium_seats[p] < premium_quota[p]) cands.push_back(p);
+        if (cands.empty())
+            for (int p = 0; p < k; p++) if (out[p].empty()) cands.push_back(p);
+        if (cands.empty())
+            for (int p = 0; p < k; p++) if (seats[p] < quota[p]) cands.push_back(p);
+        if (cands.empty())
+            for (int p = 0; p < k; p++) cands.push_back(p);
+
+        int best = cands[0];
+        for (int p : cands)
+            if (get_dist(v.depot_loc, centroids[p]) < get_dist(v.depot_loc, centroids[best])) best = p;
+        out[best].push_back(vi);
+        seats[best] += v.capacity;
+        if (v.category == PREMIUM) premium_seats[best] += v.capacity;
+    }
+    return out;
+}
+
+// ------------------------------------------------------------
+// Sub-problems
+// ------------------------------------------------------------
+struct SubProblem {
+    vector<Employee> emps;
+    vector<Vehicle> vehs;
+    vector<int> veh_ids;               // positions in the full fleet
+    map<string, string> reasons;
+};
+
+// Cheapest insertion of the sub-problem's unrouted employees, so the ALNS that
+// follows (which only re-inserts what it removed) starts with them placed.
+static void insert_unrouted(SubProblem& sp) {
+    const EmployeeIndex idx = build_employee_index(sp.emps);
+    const ObjectiveWeights w = objective_weights_from_instance();
+    SolutionState st = build_solution_state(sp.emps, sp.vehs);
+    SolutionObjective obj = evaluate_solution(sp.emps, sp.vehs);
+    for (const auto& e : sp.emps)
+        if (!e.is_routed) try_insert_anywhere(st, sp.vehs, e, idx, w, obj);
+    store_routed_flags(st, sp.emps);
+}
+
+// Copies a sub-problem's vehicles and routed flags back into the full solution.
+static void write_back(const SubProblem& sp, vector<Employee>& employees, vector<Vehicle>& vehicles,
+                       const vector<int>& pos_of_index) {
+    for (size_t j = 0; j < sp.veh_ids.size(); j++) vehicles[sp.veh_ids[j]] = sp.vehs[j];
+    for (const auto& e : sp.emps) employees[pos_of_index[e.index]].is_routed = e.is_routed;
+}
+
+// Border employees of part a towards part b: the `share` of a's employees with
+// the smallest d(e, centroid b) - d(e, centroid a).
+static vector<int> border(const vector<Employee>& emps, const vector<int>& part,
+                          const Location& ca, const Location& cb, double share) {
+    vector<pair<double, int>> key;
+    for (int i : part) key.push_back({get_dist(emps[i].pickup, cb) - get_dist(emps[i].pickup, ca), i});
+    sort(key.begin(), key.end());
+    const size_t m = min(key.size(), (size_t)ceil(share * key.size()));
+    vector<int> out;
+    for (size_t j = 0; j < m; j++) out.push_back(key[j].second);
+    return out;
+}
+
+void solve_decomposed(vector<Employee>& employees, vector<Vehicle>& vehicles,
+                      const ALNSConfig& alns_cfg, const DecomposeConfig& cfg, bool debug) {
+    const int n = (int)employees.size();
+    int k = cfg.part_size > 0 ? (n + cfg.part_size - 1) / cfg.part_size : 1;
+    k = max(1, min(k, (int)vehicles.size()));
+    const int threads = task_pool().threads();
+    const ObjectiveWeights w = objective_weights_from_instance();
+
+    const vector<vector<int>> parts = partition_employees(employees, k, cfg.method, cfg.seed);
+    k = (int)parts.size();
+    vector<Location> centroids(k);
+    for (int p = 0; p < k; p++) centroids[p] = centroid_of(employees, parts[p]);
+    const vector<vector<int>> fleet = allocate_vehicles(employees, vehicles, parts, centroids);
+
+    cout << "--- Geographic Decomposition (" << k << " parts, "
+         << (cfg.method == PARTITION_KMEANS ? "k-means" : "sweep") << ", " << min(threads, k)
+         << " threads) ---\n" << endl;
+
+    // Solve the parts concurrently: each worker owns its copies, so the only
+    // shared data is the read-only instance (g_nodes, g_compat, config).
+    vector<SubProblem> subs(k);
+    for (int p = 0; p < k; p++) {
+        for (int i : parts[p]) subs[p].emps.push_back(employees[i]);
+        for (int vi : fleet[p]) { subs[p].vehs.push_back(vehicles[vi]); subs[p].veh_ids.push_back(vi); }
+    }
+    task_pool().parallel_for(k, 1, [&](int p) {
+        SubProblem& sp = subs[p];
+        construct_solution(sp.emps, sp.vehs, ConstructionParams(), sp.reasons, false);
+        run_alns(sp.emps, sp.vehs, alns_cfg, false);
+    });
+
+    vector<int> pos_of_index(employee_index_space(employees), -1);
+    for (int i = 0; i < n; i++) pos_of_index[employees[i].index] = i;
+    for (int p = 0; p < k; p++) {
+        write_back(subs[p], employees, vehicles, pos_of_index);
+        for (const auto& kv : subs[p].reasons) g_unrouted_reason[kv.first] = kv.second;
+        if (debug) {
+            cout << "[DECOMP] part " << p << ": " << parts[p].size() << " employees, "
+                 << fleet[p].size() << " vehicles, score "
+                 << fixed << setprecision(2) << evaluate_solution(subs[p].emps, subs[p].vehs).score(w) << endl;
+        }
+    }
+    const double merged = evaluate_solution(employees, vehicles).score(w);
+
+    // Boundary repair. Neighbouring pairs: each part with its two nearest parts.
+    vector<pair<int, int>> pairs;
+    for (int a = 0; a < k; a++) {
+        vector<pair<double, int>> near;
+        for (int b = 0; b < k; b++) if (b != a) near.push_back({get_dist(centroids[a], centroids[b]), b});
+        sort(near.begin(), near.end());
+        for (size_t j = 0; j < near.size() && j < 2; j++)
+            pairs.push_back({min(a, near[j].second), max(a, near[j].second)});
+    }
+    sort(pairs.begin(), pairs.end());
+    pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+
+    ALNSConfig bcfg = alns_cfg;
+    bcfg.iterations = max(1, (int)(alns_cfg.iterations * cfg.boundary_iterations));
+    int repaired = 0;
+    for (int round = 0; round < cfg.boundary_rounds && !pairs.empty(); round++) {
+        vector<pair<int, int>> todo = pairs;
+        while (!todo.empty()) {
+            // Which vehicle serves each employee right now.
+            vector<int> veh_of(pos_of_index.size(), -1);
+            for (int vi = 0; vi < (int)vehicles.size(); vi++)
+                for (const auto& r : vehicles[vi].routes)
+                    for (const auto& s : r.stops)
+                        if (s.is_pickup()) veh_of[s.node] = vi;
+
+            // One batch = pairs with disjoint vehicle sets and disjoint parts,
+            // solved concurrently. A part's unrouted employees go to the
+            // sub-problem of every pair that contains it, so two pairs sharing a
+            // part could both route them.
+            vector<char> busy(vehicles.size(), 0);
+            vector<char> part_taken(parts.size(), 0);
+            vector<SubProblem> batch;
+            vector<pair<int, int>> later;
+            for (const auto& pr : todo) {
+                const int a = pr.first, b = pr.second;
+                vector<int> focus = border(employees, parts[a], centroids[a], centroids[b], cfg.overlap);
+                const vector<int> fb = border(employees, parts[b], centroids[b], centroids[a], cfg.overlap);
+                focus.insert(focus.end(), fb.begin(), fb.end());
+
+                vector<int> vs, loose;
+                for (int i : focus) {
+                    const int vi = veh_of[employees[i].index];
+                    if (vi >= 0) vs.push_back(vi);
+                }
+                for (int p : {a, b})
+                    for (int i : parts[p]) if (!employees[i].is_routed) loose.push_back(i);
+                sort(vs.begin(), vs.end());
+                vs.erase(unique(vs.begin(), vs.end()), vs.end());
+                if (vs.empty()) continue;
+                if (part_taken[a] || part_taken[b] ||
+                    any_of(vs.begin(), vs.end(), [&](int vi) { return busy[vi]; })) {
+                    later.push_back(pr);
+                    continue;
+                }
+
+                part_taken[a] = part_taken[b] = 1;
+                SubProblem sp;
+                for (int vi : vs) {
+                    busy[vi] = 1;
+                    sp.veh_ids.push_back(vi);
+                    sp.vehs.push_back(vehicles[vi]);
+                    for (const auto& r : vehicles[vi].routes)
+                        for (const auto& s : r.stops)
+                            if (s.is_pickup()) sp.emps.push_back(employees[pos_of_index[s.node]]);
+                }
+                for (int i : loose) sp.emps.push_back(employees[i]);
+                batch.push_back(std::move(sp));
+            }
+
+            task_pool().parallel_for((int)batch.size(), 1, [&](int j) {
+                insert_unrouted(batch[j]);
+                run_alns(batch[j].emps, batch[j].vehs, bcfg, false);
+            });
+            for (const auto& sp : batch) write_back(sp, employees, vehicles, pos_of_index);
+            repaired += (int)batch.size();
+            todo = std::move(later);
+        }
+    }
+
+    // Whatever is still unrouted gets one cheapest-insertion try over the whole
+    // fleet: a vehicle of another part may have room the local solves never saw.
+    SubProblem all;
+    all.emps = employees;
+    all.vehs = vehicles;
+    for (int vi = 0; vi < (int)vehicles.size(); vi++) all.veh_ids.push_back(vi);
+    insert_unrouted(all);
+    write_back(all, employees, vehicles, pos_of_index);
+
+    for (const auto& e : employees)
+        if (e.is_routed) g_unrouted_reason.erase(e.id);
+    const double final_score = evaluate_solution(employees, vehicles).score(w);
+    cout << "  Merged score " << fixed << setprecision(2) << merged << ", after boundary repair ("
+         << repaired << " neighbourhoods) " << final_score << "\n" << endl;
+}
+
+// ------------------------------------------------------------
+// Time layering
+// ------------------------------------------------------------
+vector<vector<int>> time_slots(const vector<Employee>& emps, int slot_minutes, int min_slot_size) {
+    slot_minutes = max(1, slot_minutes);
+    map<int, vector<int>> by_slot;
+    for (int i = 0; i < (int)emps.size(); i++)
+        by_slot[(emps[i].due_time + slot_minutes - 1) / slot_minutes].push_back(i);
+
+    vector<vector<int>> out;
+    vector<int> pending;
+    for (auto& kv : by_slot) {
+        pending.insert(pending.end(), kv.second.begin(), kv.second.end());
+        if ((int)pending.size() >= min_slot_size) { out.push_back(std::move(pending)); pending.clear(); }
+    }
+    if (!pending.empty()) {
+        if (out.empty()) out.push_back(std::move(pending));
+        else out.back().insert(out.back().end(), pending.begin(), pending.end());
+    }
+    return out;
+}
+
+// Replaces v.routes[first, last) by `trips` and re-chains what follows; empty
+// trips are dropped (an idle vehicle keeps one). False if a later trip no
+// longer fits.
+static bool splice_trips(Vehicle& v, size_t first, size_t last, const vector<Route>& trips,
+                         const EmployeeIndex& idx) {
+    vector<Route> routes;
+    for (size_t r = 0; r < first; r++) if (!is_empty_trip(v.routes[r])) routes.push_back(v.routes[r]);
+    const size_t kept = routes.size();
+    for (const auto& r : trips) if (!is_empty_trip(r)) routes.push_back(r);
+    for (size_t r = last; r < v.routes.size(); r++) if (!is_empty_trip(v.routes[r])) routes.push_back(v.routes[r]);
+    if (routes.empty()) routes.push_back(make_empty_trip(vehicle_before_trip(v, 0)));
+    v.routes = std::move(routes);
+    const bool ok = rechain_trips(v, kept > 0 ? kept - 1 : 0, idx);
+    v.total_cost = vehicle_cost(v);
+    return ok;
+}
+
+void solve_time_layered(vector<Employee>& employees, vector<Vehicle>& vehicles,
+                        const ALNSConfig& alns_cfg, const LayerConfig& cfg, bool debug) {
+    const int n = (int)employees.size();
+    const int threads = task_pool().threads();
+    const ObjectiveWeights w = objective_weights_from_instance();
+    const EmployeeIndex idx = build_employee_index(employees);
+    const vector<vector<int>> slots = time_slots(employees, cfg.slot_minutes, cfg.min_slot_size);
+    const int k = (int)slots.size();
+
+    cout << "--- Time-Layered Solve (" << k << " slots of " << cfg.slot_minutes << " min, "
+         << threads << " threads) ---\n" << endl;
+    if (debug) {
+        for (int s = 0; s < k; s++) {
+            int due = 0;
+            for (int i : slots[s]) due = max(due, employees[i].due_time);
+            cout << "[LAYER] slot " << s << ": " << slots[s].size() << " employees, due by "
+                 << due / 60 << ":" << setw(2) << setfill('0') << due % 60 << setfill(' ') << endl;
+        }
+    }
+
+    vector<int> pos_of_index(employee_index_space(employees), -1);
+    vector<int> slot_of(pos_of_index.size(), -1);
+    for (int i = 0; i < n; i++) pos_of_index[employees[i].index] = i;
+    for (int s = 0; s < k; s++)
+        for (int i : slots[s]) slot_of[employees[i].index] = s;
+    for (auto& v : vehicles) if (v.available_time == 0) v.available_time = parse_time("08:00");
+
+    // Construction, chronologically: each slot sees the fleet as the earlier
+    // slots left it and appends its trips.
+    for (int s = 0; s < k; s++) {
+        SubProblem sp;
+        for (int i : slots[s]) sp.emps.push_back(employees[i]);
+        for (const auto& v : vehicles) sp.vehs.push_back(vehicle_before_trip(v, v.routes.size()));
+        construct_solution(sp.emps, sp.vehs, ConstructionParams(), sp.reasons, false);
+        for (size_t vi = 0; vi < vehicles.size(); vi++) {
+            const size_t end = vehicles[vi].routes.size();
+            splice_trips(vehicles[vi], end, end, sp.vehs[vi].routes, idx);
+        }
+        for (const auto& e : sp.emps) employees[pos_of_index[e.index]].is_routed = e.is_routed;
+        for (const auto& kv : sp.reasons) g_unrouted_reason[kv.first] = kv.second;
+    }
+    const double layered = evaluate_solution(employees, vehicles).score(w);
+
+    // Trips [first, last) of vehicle vi that carry slot s, or an empty range.
+    auto slot_range = [&](int vi, int s) {
+        const auto& routes = vehicles[vi].routes;
+        size_t first = routes.size(), last = routes.size();
+        for (size_t r = 0; r < routes.size(); r++) {
+            if (is_empty_trip(routes[r]) || slot_of[routes[r].stops[1].node] != s) continue;
+            if (first == routes.size()) first = r;
+            last = r + 1;
+        }
+        return make_pair(first, last);
+    };
+
+    // Slot-local ALNS, in waves of slots whose vehicle sets are disjoint. A
+    // slot's result is spliced back only if the whole plan does not get worse
+    // (its trips may end later and push the vehicle's next slot).
+    ALNSConfig scfg = alns_cfg;
+    scfg.iterations = max(1, (int)(alns_cfg.iterations * cfg.slot_iterations));
+    vector<int> todo(k);
+    for (int s = 0; s < k; s++) todo[s] = s;
+    int kept = 0;
+    while (!todo.empty()) {
+        vector<char> busy(vehicles.size(), 0);
+        vector<int> wave, later;
+        vector<SubProblem> subs;
+        for (int s : todo) {
+            vector<int> vs;
+            for (int vi = 0; vi < (int)vehicles.size(); vi++)
+                if (slot_range(vi, s).first < vehicles[vi].routes.size()) vs.push_back(vi);
+            if (vs.empty()) continue;
+            if (any_of(vs.begin(), vs.end(), [&](int vi) { return busy[vi]; })) { later.push_back(s); continue; }
+
+            SubProblem sp;
+            for (int i : slots[s]) sp.emps.push_back(employees[i]);
+            for (int vi : vs) {
+                busy[vi] = 1;
+                const auto range = slot_range(vi, s);
+                Vehicle sub = vehicle_before_trip(vehicles[vi], range.first);
+                sub.routes.assign(vehicles[vi].routes.begin() + range.first, vehicles[vi].routes.begin() + range.second);
+                sp.vehs.push_back(std::move(sub));
+                sp.veh_ids.push_back(vi);
+            }
+            wave.push_back(s);
+            subs.push_back(std::move(sp));
+        }
+
+        task_pool().parallel_for((int)subs.size(), 1, [&](int j) {
+            insert_unrouted(subs[j]);
+            run_alns(subs[j].emps, subs[j].vehs, scfg, false);
+        });
+
+        for (size_t j = 0; j < subs.size(); j++) {
+            const SubProblem& sp = subs[j];
+            const double before = evaluate_solution(employees, vehicles).score(w);
+            vector<Vehicle> saved;
+            for (int vi : sp.veh_ids) saved.push_back(vehicles[vi]);
+            vector<char> saved_flags;
+            for (const auto& e : sp.emps) saved_flags.push_back(employees[pos_of_index[e.index]].is_routed);
+
+            bool ok = true;
+            for (size_t t = 0; t < sp.veh_ids.size(); t++) {
+                const int vi = sp.veh_ids[t];
+                const auto range = slot_range(vi, wave[j]);
+                ok = splice_trips(vehicles[vi], range.first, range.second, sp.vehs[t].routes, idx) && ok;
+            }
+            for (const auto& e : sp.emps) employees[pos_of_index[e.index]].is_routed = e.is_routed;
+            if (ok && evaluate_solution(employees, vehicles).score(w) <= before + 1e-9) { kept++; continue; }
+
+            for (size_t t = 0; t < sp.veh_ids.size(); t++) vehicles[sp.veh_ids[t]] = saved[t];
+            for (size_t t = 0; t < sp.emps.size(); t++) employees[pos_of_index[sp.emps[t].index]].is_routed = saved_flags[t];
+        }
+        todo = std::move(later);
+    }
+    const double local = evaluate_solution(employees, vehicles).score(w);
+
+    // Cross-slot pass over the whole plan.
+    ALNSConfig fcfg = alns_cfg;
+    fcfg.iterations = max(1, (int)(alns_cfg.iterations * cfg.final_iterations));
+    run_alns(employees, vehicles, fcfg, debug);
+
+    for (const auto& e : employees)
+        if (e.is_routed) g_unrouted_reason.erase(e.id);
+    cout << "  Layered score " << fixed << setprecision(2) << layered << ", after slot ALNS ("
+         << kept << "/" << k << " kept) " << local << ", after cross-slot pass "
+         << evaluate_solution(employees, vehicles).score(w) << "\n" << endl;
+}
@@ -18,10 +18,10 @@ int travel_minutes(double dist_km, double speed_kmh) {
     return (int)llround((dist_km / speed_kmh) * 60.0);
 }
 
-double recompute_distance_km(const std::vector<Stop>& stops) {
+double recompute_distance_km(const StopList& stops) {
     double dist = 0.0;
     for (size_t i = 1; i < stops.size(); i++) {
-        dist += get_dist(stops[i-1].loc, stops[i].loc);
+        dist += get_dist(stops[i-1].loc(), stops[i].loc());
     }
     return dist;
 }
@@ -3,19 +3,36 @@
 #include "time_utils.h"
 #include "config.h"
 #include "stubs.h"
+#include "lateness.h"
+#include "objective.h"
+#include "route_eval.h"
+#include "task_pool.h"
 #include <iostream>
 #include <iomanip>
 #include <numeric>
 #include <algorithm>
+#include <cmath>
+#include <random>
 
 using namespace std;
 
 
-vector<int> get_sorted_indices_by_tightness(const vector<Employee>& emps) {
-    vector<int> indices(emps.size());
+// Employees with identical keys keep input order unless a tie-break seed is given,
+// in which case they are shuffled first and the stable sort keeps that shuffle.
+static vector<int> initial_order(size_t n, unsigned tie_break_seed) {
+    vector<int> indices(n);
     iota(indices.begin(), indices.end(), 0); // Fill with 0, 1, 2, ...
+    if (tie_break_seed != 0) {
+        mt19937 rng(tie_break_seed);
+        shuffle(indices.begin(), indices.end(), rng);
+    }
+    return indices;
+}
 
-    sort(indices.begin(), indices.end(), [&emps](int a, int b) {
+vector<int> get_sorted_indices_by_tightness(const vector<Employee>& emps, unsigned tie_break_seed) {
+    vector<int> indices = initial_order(emps.size(), tie_break_seed);
+
+    stable_sort(indices.begin(), indices.end(), [&emps](int a, int b) {
         if (emps[a].due_time != emps[b].due_time) return emps[a].due_time < emps[b].due_time;
         return emps[a].ready_time < emps[b].ready_time;
     });
@@ -23,319 +40,215 @@ vector<int> get_sorted_indices_by_tightness(const vector<Employee>& emps) {
     return indices;
 }
 
-
-static bool simulate_insertion_and_check(
-    const Route& route,
-    const Employee& emp,
-    int insert_before_idx,
-    double speed_kmh,
-    const map<string, Employee*>& emp_by_id,
-    vector<Stop>& out_stops,
-    string& fail_reason
-) {
-    if (route.stops.empty()) {
-        fail_reason = "route has no start";
-        return false;
-    }
-
-    // Valid insert positions are between START and END (i.e., [1, size-1])
-    // where insert_before_idx refers to the index in the *existing* route before which we insert.
-    // For example, inserting before END means insert_before_idx == route.stops.size() - 1.
-    if (insert_before_idx < 1 || insert_before_idx > (int)route.stops.size() - 1) {
-        fail_reason = "invalid insertion position";
-        return false;
-    }
-
-    // Enforce structure: last stop must be END at office.
-    if (route.stops.back().emp_id != "END") {
-        fail_reason = "route missing END sentinel";
-        return false;
-    }
-
-    // Build stop list with the new pickup inserted.
-    out_stops.clear();
-    out_stops.reserve(route.stops.size() + 1);
-    for (int i = 0; i < insert_before_idx; i++) out_stops.push_back(route.stops[i]);
-
-    Stop pu;
-    pu.emp_id = emp.id;
-    pu.loc = emp.pickup;
-    pu.is_pickup = true;
-    pu.arrival_time = pu.begin_service = pu.departure_time = 0;
-    out_stops.push_back(pu);
-
-    for (int i = insert_before_idx; i < (int)route.stops.size(); i++) out_stops.push_back(route.stops[i]);
-
-    const int SERVICE_PICKUP_MIN = 2;
-
-    // START times are fixed by the vehicle's availability.
-    out_stops[0].arrival_time = route.stops[0].arrival_time;
-    out_stops[0].begin_service = route.stops[0].begin_service;
-    out_stops[0].departure_time = route.stops[0].departure_time;
-     // After calculating times for the inserted employee:
-
-    // Resimulate timeline.
-    for (int i = 1; i < (int)out_stops.size(); i++) {
-        // After calculating times for the inserted employee:
-
-        double dist_km = get_dist(out_stops[i - 1].loc, out_stops[i].loc);
-        int tmin = travel_minutes(dist_km, speed_kmh);
-        int arrival = out_stops[i - 1].departure_time + tmin;
-        out_stops[i].arrival_time = arrival;
-      // After calculating times for the inserted employee:
-        if (out_stops[i].emp_id == "END") {
-            // Office end: no service time.
-            out_stops[i].begin_service = arrival;
-            out_stops[i].departure_time = arrival;
-        } else {
-            auto it = emp_by_id.find(out_stops[i].emp_id);
-            if (it == emp_by_id.end() || it->second == nullptr) {
-                fail_reason = "unknown employee in route";
-                return false;
-            }
-            const Employee& ei = *it->second;
-            // Respect earliest pickup (ready time): wait if early.
-            out_stops[i].begin_service = max(arrival, ei.ready_time);
-            out_stops[i].departure_time = out_stops[i].begin_service + SERVICE_PICKUP_MIN;
-          
-// cout << "[DEBUG] " << ei.id << ": arrival=" << arrival 
-//      << ", ready=" << ei.ready_time 
-//      << ", begin=" << max(arrival, ei.ready_time) << endl;
-out_stops[i].begin_service = max(arrival, ei.ready_time);
+vector<int> get_seed_order(const vector<Employee>& emps, SeedStrategy seed, unsigned tie_break_seed) {
+    if (seed == SEED_EARLIEST_DUE) return get_sorted_indices_by_tightness(emps, tie_break_seed);
+
+    vector<int> indices = initial_order(emps.size(), tie_break_seed);
+
+    if (seed == SEED_FARTHEST) {
+        // Far-away employees are the hardest to fit; place them while trips are empty.
+        vector<double> d(emps.size());
+        for (size_t i = 0; i < emps.size(); i++) d[i] = get_dist(emps[i].pickup, OFFICE);
+        stable_sort(indices.begin(), indices.end(), [&](int a, int b) { return d[a] > d[b]; });
+    } else {
+        // Sweep: polar angle of the pickup around OFFICE, ties by due time.
+        vector<double> ang(emps.size());
+        for (size_t i = 0; i < emps.size(); i++) {
+            ang[i] = atan2(emps[i].pickup.lat - OFFICE.lat, emps[i].pickup.lng - OFFICE.lng);
         }
+        stable_sort(indices.begin(), indices.end(), [&](int a, int b) {
+            if (ang[a] != ang[b]) return ang[a] < ang[b];
+            return emps[a].due_time < emps[b].due_time;
+        });
     }
-
-    // Enforce latest drop for ALL picked employees: office arrival must be <= due_time.
-    const int office_arrival = out_stops.back().arrival_time;
-    for (int i = 1; i < (int)out_stops.size() - 1; i++) {
-        const string& eid = out_stops[i].emp_id;
-        auto it = emp_by_id.find(eid);
-        if (it == emp_by_id.end() || it->second == nullptr) continue;
-        const Employee& ei = *it->second;
-        if (office_arrival > ei.due_time) {
-            fail_reason = "latest_drop violated for " + eid;
-            return false;
-        }
-    }
-
-    return true;
+    return indices;
 }
 
 
-// Solomon c1 criterion: insertion cost
-double calc_c1(const Route& route, const Employee& emp, int pos, double speed_kmh) {
+// Solomon c1 criterion: insertion cost (distance detour + time push).
+// With cost weighting the detour is priced in Rs using the vehicle's cost_per_km,
+// so a cheap vehicle can win over a slightly shorter detour on an expensive one.
+double calc_c1(const Route& route, const Employee& emp, int pos, const Vehicle& veh,
+               const ConstructionParams& p) {
+    const double scale = p.cost_weighted ? veh.cost_per_km : 1.0;
     if (route.stops.size() <= 1) {
         // Only depot exists
-        double dist = get_dist(route.stops.front().loc, emp.pickup);
-        return MU * dist;
+        double dist = get_dist(route.stops.front().loc(), emp.pickup);
+        return p.mu * dist * scale;
     }
-    
-    Location prev_loc = (pos == 0) ? route.stops[0].loc : route.stops[pos - 1].loc;
-    Location next_loc = (pos >= route.stops.size() - 1) ? route.stops.back().loc : route.stops[pos].loc;
-    
+
+    Location prev_loc = (pos == 0) ? route.stops[0].loc() : route.stops[pos - 1].loc();
+    Location next_loc = (pos >= (int)route.stops.size() - 1) ? route.stops.back().loc() : route.stops[pos].loc();
+
     double d_iu = get_dist(prev_loc, emp.pickup);
     double d_uj = get_dist(emp.pickup, next_loc);
     double d_ij = get_dist(prev_loc, next_loc);
-    
-    double c11 = d_iu + d_uj - MU * d_ij;
-    
+
+    double c11 = (d_iu + d_uj - p.mu * d_ij) * scale;
+
     int prev_time = (pos == 0) ? route.stops[0].departure_time : route.stops[pos - 1].departure_time;
-    double t_iu = (d_iu / speed_kmh) * 60.0;
+    double t_iu = (d_iu / veh.speed_kmh) * 60.0;
     int b_u = max((int)(prev_time + t_iu), emp.ready_time);
-    
+
     double c12 = b_u - prev_time;
-    
-    return ALPHA1 * c11 + ALPHA2 * c12;
+
+    return p.alpha1 * c11 + p.alpha2 * c12;
 }
 
 // Solomon c2 criterion: customer selection
-double calc_c2(const Route& route, const Employee& emp, double c1_val, double speed_kmh) {
-    double d_0u = get_dist(route.stops[0].loc, emp.pickup);
-    return LAMBDA * d_0u - c1_val;
+double calc_c2(const Route& route, const Employee& emp, double c1_val, const Vehicle& veh,
+               const ConstructionParams& p) {
+    const double scale = p.cost_weighted ? veh.cost_per_km : 1.0;
+    double d_0u = get_dist(route.stops[0].loc(), emp.pickup);
+    return p.lambda * d_0u * scale - c1_val;
 }
 
-bool check_compatibility(const Vehicle& v, const Employee& e, const Route& route) {
-    if (e.veh_pref == PREMIUM && v.category != PREMIUM) return false;
-    // if (e.veh_pref == NORMAL && v.category == PREMIUM) return false;
-    
-    int emp_limit = 100;
-    // if (e.share_pref == SINGLE) emp_limit = 1;
-    // else if (e.share_pref == DOUBLE) emp_limit = 2;
-    // else if (e.share_pref == TRIPLE) emp_limit = 3;
-    
-    int effective_capacity = min(route.max_capacity, min((int)v.capacity, emp_limit));
-    // route.current_capacity is number of passengers already in this trip.
-    if (route.current_capacity + 1 > effective_capacity) return false;
-    
-    return true;
+// Would committing `stops` to trip r keep every later trip of the vehicle feasible?
+// Only pays for a copy when the trip actually runs into the next one.
+static bool chain_feasible(const Vehicle& veh, size_t r, const StopList& stops,
+                           const EmployeeIndex& idx) {
+    if (chain_has_slack(veh, r, stops.back().departure_time)) return true;
+    Vehicle tmp = veh;
+    tmp.routes[r].stops = stops;
+    return rechain_trips(tmp, r, idx);
 }
 
-// Simple regret-2 implementation
-double calculate_regret(const Route& route, const Employee& emp, 
-                       double speed_kmh, const map<string, Employee*>& emp_by_id) {
-    double best_c1 = INF, second_best_c1 = INF;
-    int best_pos = -1;
-    
-    for (int pos = 1; pos <= (int)route.stops.size() - 1; pos++) {
-        vector<Stop> cand;
-        string why;
-        if (!simulate_insertion_and_check(route, emp, pos, speed_kmh, emp_by_id, cand, why)) {
-            continue;
-        }
-        
-        double new_dist = recompute_distance_km(cand);
-        double old_dist = recompute_distance_km(route.stops);
-        double c1_val = MU * max(0.0, new_dist - old_dist);
-        
-        if (c1_val < best_c1) {
-            second_best_c1 = best_c1;
-            best_c1 = c1_val;
-            best_pos = pos;
-        } else if (c1_val < second_best_c1) {
-            second_best_c1 = c1_val;
-        }
-    }
-    
-    if (best_pos == -1) return -INF; // No feasible insertion
-    if (second_best_c1 == INF) return 0; // Only one feasible position
-    
-    return second_best_c1 - best_c1; // Regret value
-}
-// SOLOMON I1 HEURISTIC IMPLEMENTATION
-void solve_solomon_insertion(vector<Employee>& emps, vector<Vehicle>& vehs, bool debug) {
-    
-    cout << "--- Solomon I1 Insertion Heuristic (No Priority) ---\n" << endl;
-    // Build quick lookup for time windows.
-    map<string, Employee*> emp_by_id;
-    for (auto& e : emps) emp_by_id[e.id] = &e;
+// PARAMETERIZED SOLOMON I1 CONSTRUCTION
+void construct_solution(vector<Employee>& emps, vector<Vehicle>& vehs,
+                        const ConstructionParams& params,
+                        map<string, string>& unrouted_reason,
+                        bool debug) {
+
+    const EmployeeIndex emp_by_id = build_employee_index(emps);
 
-    // Step 1: Initialize 1 open trip per vehicle
+    // Step 1: Initialize 1 open trip per vehicle, starting from the dataset location.
     for (auto& v : vehs) {
         if (v.available_time == 0) v.available_time = parse_time("08:00");
-        Route initial_route;
-        
-        // Trip #1 start: vehicle's dataset start location.
-        Stop depot_start;
-        depot_start.emp_id = "START";
-        depot_start.loc = v.current_loc;
-        depot_start.arrival_time = v.available_time;
-        depot_start.begin_service = v.available_time;
-        depot_start.departure_time = v.available_time;
-        depot_start.is_pickup = false;
-        
-        initial_route.stops.push_back(depot_start);
-
-        // Trip end sentinel: the common corporate office.
-        Stop depot_end = depot_start;
-        depot_end.emp_id = "END";
-        depot_end.loc = OFFICE;
-        initial_route.stops.push_back(depot_end);
-        initial_route.current_capacity = 0;
-        initial_route.max_capacity = (int)v.capacity;
-        initial_route.total_distance = 0;
-        initial_route.total_cost = 0;
-        
+        Route initial_route = make_empty_trip(v);
+        simulate_route(initial_route, v, emp_by_id);
         v.routes.push_back(initial_route);
     }
-    
+
     if (debug) {
         cout << "[DEBUG] Initialized " << vehs.size() << " routes (one per vehicle)" << endl;
         cout << "[DEBUG] Processing employees in order: ";
         for (const auto& e : emps) cout << e.id << " ";
         cout << "\n" << endl;
     }
-    vector<int> sorted_indices = get_sorted_indices_by_tightness(emps);
+    vector<int> sorted_indices = get_seed_order(emps, params.seed, params.tie_break_seed);
     // Step 2: Insert employees one by one using Solomon's criteria
     for (size_t order_idx = 0; order_idx < sorted_indices.size(); order_idx++) {
          int emp_idx = sorted_indices[order_idx];
          if (emps[emp_idx].is_routed) continue;
-    
-        
+
+
         if (debug) cout << "\n[" << emps[emp_idx].id << "] Finding best insertion..." << endl;
-        
+
         double best_c2 = -INF;
         int best_vehicle_idx = -1;
         int best_route_idx = -1;
         int best_insert_pos = -1;
-        double best_c1 = INF;
-        
-        // Try inserting in ALL routes of ALL vehicles
-        for (size_t v_idx = 0; v_idx < vehs.size(); v_idx++) {
-            Vehicle& veh = vehs[v_idx];
-            
+        StopList best_stops;
+
+        // Try inserting in the open trips of ALL vehicles. Vehicles are scanned
+        // independently on the task pool (in order under debug, so the log reads
+        // as before); the pick then goes in fleet order, so ties resolve as in a
+        // serial scan.
+        struct VehicleBest {
+            double c2 = -INF;
+            int route_idx = -1;
+            int insert_pos = -1;
+            StopList stops;
+        };
+        vector<VehicleBest> per_vehicle(vehs.size());
+        const int grain = debug ? (int)vehs.size() : 4;
+        task_pool().parallel_for((int)vehs.size(), grain, [&](int v_idx) {
+            const Vehicle& veh = vehs[v_idx];
+            VehicleBest& vb = per_vehicle[v_idx];
+
             for (size_t r_idx = 0; r_idx < veh.routes.size(); r_idx++) {
-                // Only build on the vehicle's current (last) trip; earlier trips are already finished.
-                if (r_idx + 1 != veh.routes.size()) continue;
-                Route& route = veh.routes[r_idx];
-                
+                // Sequential mode only builds on the vehicle's current (last) trip.
+                if (!params.parallel_routes && r_idx + 1 != veh.routes.size()) continue;
+                const Route& route = veh.routes[r_idx];
+
                 // Check compatibility
                 if (!check_compatibility(veh, emps[emp_idx], route)) {
                     if (debug) cout << "  [" << veh.id << "-R" << r_idx << "] Incompatible" << endl;
                     continue;
                 }
-                
-                // Try all insertion positions (insert pickup BEFORE index insert_before_idx)
+
+                // Try all insertion positions (insert pickup BEFORE index insert_before_idx),
+                // keeping the best and second-best c1 for the regret term.
                 double best_c1_this_route = INF;
+                double second_c1_this_route = INF;
                 int best_insert_before_this_route = -1;
-                vector<Stop> best_stops_this_route;
+                StopList best_stops_this_route;
 
-                const double old_dist = recompute_distance_km(route.stops);
                 // Valid positions are 1..size-1 (i.e., between START and END)
                 for (int insert_before_idx = 1; insert_before_idx <= (int)route.stops.size() - 1; insert_before_idx++) {
-                    vector<Stop> cand;
+                    StopList cand;
                     string why;
-                    if (!simulate_insertion_and_check(route, emps[emp_idx], insert_before_idx, veh.speed_kmh, emp_by_id, cand, why)) {
+                    if (!simulate_insertion(route, emps[emp_idx], insert_before_idx, veh.speed_kmh, emp_by_id, cand, why)) {
                         continue;
                     }
+                    if (!chain_feasible(veh, r_idx, cand, emp_by_id)) continue;
+
+                    double c1_val = calc_c1(route, emps[emp_idx], insert_before_idx, veh, params);
+                    // Price lateness on the same scale as the distance term.
+                    const int new_arrival = cand.back().arrival_time;
+                    const double late_delta = profile_penalty(route.late, new_arrival)
+                                            + lateness_penalty(emps[emp_idx], new_arrival)
+                                            - route.lateness_penalty;
+                    if (params.cost_weighted) c1_val += late_delta;
+                    else if (veh.cost_per_km > 0.0) c1_val += late_delta / veh.cost_per_km;
 
-                    const double new_dist = recompute_distance_km(cand);
-                    const double delta = max(0.0, new_dist - old_dist);
-                    // const double c1_val = MU * delta;
-                       const double c1_val = calc_c1( route,emps[emp_idx],insert_before_idx,veh.speed_kmh);
                     if (c1_val < best_c1_this_route) {
+                        second_c1_this_route = best_c1_this_route;
                         best_c1_this_route = c1_val;
                         best_insert_before_this_route = insert_before_idx;
                         best_stops_this_route = std::move(cand);
+                    } else if (c1_val < second_c1_this_route) {
+                        second_c1_this_route = c1_val;
                     }
                 }
 
                 // If we found a feasible insertion in this route
                 if (best_insert_before_this_route != -1) {
-                    const double d_0u = get_dist(route.stops.front().loc, emps[emp_idx].pickup);
-                    const double regret = calculate_regret(route, emps[emp_idx], veh.speed_kmh, emp_by_id);
-                    const double c2_val = LAMBDA * d_0u - best_c1_this_route+0.5*regret;
+                    const double regret = (second_c1_this_route < INF) ? second_c1_this_route - best_c1_this_route : 0.0;
+                    const double c2_val = calc_c2(route, emps[emp_idx], best_c1_this_route, veh, params) + 0.5 * regret;
 
                     if (debug) {
                         cout << "  [" << veh.id << "-R" << r_idx << "] c1=" << best_c1_this_route
                              << ", c2=" << c2_val << ", insert_before=" << best_insert_before_this_route << endl;
                     }
 
-                    if (c2_val > best_c2) {
-                        best_c2 = c2_val;
-                        best_vehicle_idx = (int)v_idx;
-                        best_route_idx = (int)r_idx;
-                        best_insert_pos = best_insert_before_this_route;
-                        best_c1 = best_c1_this_route;
-                        // Stash the actual schedule so we can apply it later.
-                        // (We re-simulate once more below to keep this patch minimal.)
+                    if (c2_val > vb.c2) {
+                        vb.c2 = c2_val;
+                        vb.route_idx = (int)r_idx;
+                        vb.insert_pos = best_insert_before_this_route;
+                        // Stash the actual schedule so we can apply it without re-simulating.
+                        vb.stops = std::move(best_stops_this_route);
                     }
                 }
             }
+        });
+
+        for (size_t v_idx = 0; v_idx < vehs.size(); v_idx++) {
+            VehicleBest& vb = per_vehicle[v_idx];
+            if (vb.route_idx != -1 && vb.c2 > best_c2) {
+                best_c2 = vb.c2;
+                best_vehicle_idx = (int)v_idx;
+                best_route_idx = vb.route_idx;
+                best_insert_pos = vb.insert_pos;
+                best_stops = std::move(vb.stops);
+            }
         }
-        
+
         // Insert employee into best position
         if (best_vehicle_idx != -1) {
             Vehicle& veh = vehs[best_vehicle_idx];
             Route& route = veh.routes[best_route_idx];
 
-            vector<Stop> new_stops;
-            string why;
-            if (!simulate_insertion_and_check(route, emps[emp_idx], best_insert_pos, veh.speed_kmh, emp_by_id, new_stops, why)) {
-                // This should be rare; treat as unrouted with an explicit reason.
-                g_unrouted_reason[emps[emp_idx].id] = "Insertion became infeasible at apply-time: " + why;
-                continue;
-            }
-
             // Update route capacity limit based on the strictest sharing pref in this trip.
             int emp_limit = 100;
             // if (emps[emp_idx].share_pref == SINGLE) emp_limit = 1;
@@ -343,17 +256,13 @@ void solve_solomon_insertion(vector<Employee>& emps, vector<Vehicle>& vehs, bool
             // else if (emps[emp_idx].share_pref == TRIPLE) emp_limit = 3;
             route.max_capacity = min(route.max_capacity, min((int)veh.capacity, emp_limit));
 
-            route.stops = std::move(new_stops);
-            route.current_capacity++;
-
-            route.total_distance = recompute_distance_km(route.stops);
-            route.total_cost = route.total_distance * veh.cost_per_km;
-            // Vehicle becomes available again at office (END).
-            veh.available_time = route.stops.back().departure_time;
-            veh.current_loc = route.stops.back().loc;
+            route.stops = std::move(best_stops);
+            finalize_route(route, veh, emp_by_id);
+            // Later trips leave once this one is back at the office (END).
+            rechain_trips(veh, (size_t)best_route_idx, emp_by_id);
 
             emps[emp_idx].is_routed = true;
-            g_unrouted_reason.erase(emps[emp_idx].id);
+            unrouted_reason.erase(emps[emp_idx].id);
 
             if (debug) {
                 cout << "  >>> INSERTED into " << veh.id << "-R" << best_route_idx
@@ -363,65 +272,55 @@ void solve_solomon_insertion(vector<Employee>& emps, vector<Vehicle>& vehs, bool
         } else {
             // No feasible insertion found - start new route on least-cost vehicle
             if (debug) cout << "  >>> Starting NEW ROUTE" << endl;
-            
-            bool started = false;
+
+            int best_v = -1;
+            double best_trip_cost = INF;
+            Route best_trip;
             string fail_reason = "No feasible insertion and could not start a new trip (category/capacity/time window)";
 
-            // Find any vehicle that can accommodate as a brand-new trip
-            for (auto& v : vehs) {
+            // Find the vehicle that can serve the employee as a brand-new trip most cheaply
+            for (size_t v_idx = 0; v_idx < vehs.size(); v_idx++) {
+                Vehicle& v = vehs[v_idx];
                 // Check if we can start a new route
                 int emp_limit = 100;
                 // if (emps[emp_idx].share_pref == SINGLE) emp_limit = 1;
                 // else if (emps[emp_idx].share_pref == DOUBLE) emp_limit = 2;
                 // else if (emps[emp_idx].share_pref == TRIPLE) emp_limit = 3;
-                
+
                 if (emp_limit == 0) continue;
                 if (emps[emp_idx].veh_pref == PREMIUM && v.category != PREMIUM) continue;
                 // if (emps[emp_idx].veh_pref == NORMAL && v.category == PREMIUM) continue;
-                
+
                 // Create new route (Trip #2+): must start from OFFICE.
-                Route new_route;
-
-                Stop depot;
-                depot.emp_id = "START";
-                depot.loc = OFFICE; // subsequent trips start from office hub
-                depot.arrival_time = v.available_time;
-                depot.begin_service = v.available_time;
-                depot.departure_time = v.available_time;
-                depot.is_pickup = false;
-                new_route.stops.push_back(depot);
-
-                Stop depot_end = depot;
-                depot_end.emp_id = "END";
-                depot_end.loc = OFFICE;
-                new_route.stops.push_back(depot_end);
-
-                vector<Stop> planned;
+                Route new_route = make_next_trip(v);
+                new_route.max_capacity = min((int)v.capacity, emp_limit);
+
+                Route planned = new_route;
                 string why;
-                if (!simulate_insertion_and_check(new_route, emps[emp_idx], 1, v.speed_kmh, emp_by_id, planned, why)) {
+                if (!insert_pickup(new_route, emps[emp_idx], 1, v, emp_by_id, planned, why)) {
                     fail_reason = "Could not start a new trip: " + why;
                     continue;
                 }
+                new_route = std::move(planned);
 
-                new_route.stops = std::move(planned);
-                new_route.current_capacity = 1;
-                new_route.max_capacity = min((int)v.capacity, emp_limit);
-                new_route.total_distance = recompute_distance_km(new_route.stops);
-                new_route.total_cost = new_route.total_distance * v.cost_per_km;
+                const double trip_cost = params.cost_weighted ? new_route.total_cost : new_route.total_distance;
+                if (trip_cost < best_trip_cost) {
+                    best_trip_cost = trip_cost;
+                    best_v = (int)v_idx;
+                    best_trip = std::move(new_route);
+                }
+            }
 
-                v.available_time = new_route.stops.back().departure_time;
-                v.current_loc = new_route.stops.back().loc;
-                v.routes.push_back(std::move(new_route));
+            if (best_v != -1) {
+                Vehicle& v = vehs[best_v];
+                v.routes.push_back(std::move(best_trip));
+                rechain_trips(v, v.routes.size() - 1, emp_by_id);
                 emps[emp_idx].is_routed = true;
-                g_unrouted_reason.erase(emps[emp_idx].id);
+                unrouted_reason.erase(emps[emp_idx].id);
 
                 if (debug) cout << "  >>> NEW ROUTE started on " << v.id << endl;
-                started = true;
-                break;
-            }
-
-            if (!started) {
-                g_unrouted_reason[emps[emp_idx].id] = fail_reason;
+            } else {
+                unrouted_reason[emps[emp_idx].id] = fail_reason;
                 if (debug) cout << "  !!! DROPPED " << emps[emp_idx].id << " : " << fail_reason << endl;
             }
         }
@@ -429,15 +328,85 @@ void solve_solomon_insertion(vector<Employee>& emps, vector<Vehicle>& vehs, bool
 
     // Recompute vehicle totals cleanly
     for (auto& v : vehs) {
-        v.total_cost = 0.0;
         for (auto& r : v.routes) {
             // ensure costs are consistent
-            r.total_distance = recompute_distance_km(r.stops);
-            r.total_cost = r.total_distance * v.cost_per_km;
-            if (r.stops.size() > 1) v.total_cost += r.total_cost;
+            finalize_route(r, v, emp_by_id);
         }
+        v.total_cost = vehicle_cost(v);
     }
+}
+
+// SOLOMON I1 HEURISTIC IMPLEMENTATION
+void solve_solomon_insertion(vector<Employee>& emps, vector<Vehicle>& vehs, bool debug) {
+
+    cout << "--- Solomon I1 Insertion Heuristic (Priority-Aware Soft Windows) ---\n" << endl;
+
+    ConstructionParams params;
+    construct_solution(emps, vehs, params, g_unrouted_reason, debug);
 
     cout << "\n--- Optimization Complete ---\n" << endl;
 }
 
+// Start 0 keeps the defaults; the others jitter the Solomon weights, rotate the
+// seeding strategy and shuffle ties so each pass explores a different start.
+static ConstructionParams perturbed_params(int start, unsigned seed) {
+    ConstructionParams p;
+    if (start == 0) return p;
+
+    mt19937 rng(seed + 7919u * (unsigned)start);
+    uniform_real_distribution<double> U(0.0, 1.0);
+    p.alpha1 = ALPHA1 * (0.5 + U(rng));
+    p.alpha2 = ALPHA2 + 0.5 * U(rng);
+    p.lambda = LAMBDA * (0.5 + 1.5 * U(rng));
+    p.mu = MU * (0.7 + 0.6 * U(rng));
+    p.seed = (SeedStrategy)(start % 3);
+    p.tie_break_seed = rng() | 1u;
+    return p;
+}
+
+void solve_multistart(vector<Employee>& emps, vector<Vehicle>& vehs,
+                      const MultiStartConfig& cfg, bool debug) {
+    const int starts = max(1, cfg.starts);
+    const int threads = min(task_pool().threads(), starts);
+
+    cout << "--- Multi-Start Solomon Construction (" << starts << " starts, "
+         << threads << " threads) ---\n" << endl;
+
+    struct StartResult {
+        vector<Employee> emps;
+        vector<Vehicle> vehs;
+        map<string, string> reasons;
+        double score = INF;
+    };
+    vector<StartResult> results(starts);
+    const ObjectiveWeights w = objective_weights_from_instance();
+
+    // Each start gets its own copy of the fleet and employees; nothing is shared
+    // but read-only instance data, so the passes need no locking. The constructor's
+    // own vehicle scan runs inline inside a start (nested pool calls do).
+    task_pool().parallel_for(starts, 1, [&](int s) {
+        StartResult& r = results[s];
+        r.emps = emps;
+        r.vehs = vehs;
+        construct_solution(r.emps, r.vehs, perturbed_params(s, cfg.seed), r.reasons, false);
+        r.score = evaluate_solution(r.emps, r.vehs).score(w);
+    });
+
+    // Lowest score wins; ties go to the lower start index so the pick is thread-independent.
+    int best = 0;
+    for (int s = 1; s < starts; s++) {
+        if (results[s].score < results[best].score) best = s;
+    }
+    if (debug) {
+        for (int s = 0; s < starts; s++) {
+            cout << "[DEBUG] start " << s << " score=" << results[s].score << (s == best ? "  <== best" : "") << endl;
+        }
+    }
+
+    emps = std::move(results[best].emps);
+    vehs = std::move(results[best].vehs);
+    for (const auto& kv : results[best].reasons) g_unrouted_reason[kv.first] = kv.second;
+
+    cout << "  Best start: #" << best << " (score " << fixed << setprecision(2) << results[best].score << ")" << endl;
+    cout << "\n--- Optimization Complete ---\n" << endl;
+}
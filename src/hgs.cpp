@@ -0,0 +1,346 @@
+#include "hgs.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include "config.h"
+#include "geo.h"
+#include "local_search.h"
+#include "objective.h"
+#include "route_eval.h"
+#include "zobrist.h"
+
+using namespace std;
+
+namespace {
+
+struct Individual {
+    vector<int> tour;                // giant tour: instance indices in pickup order
+    vector<Vehicle> vehs;
+    SolutionObjective obj;
+    double score = numeric_limits<double>::infinity();
+    vector<int> succ;                // per instance index: next pickup, -1 = END, -2 = unrouted
+    double fitness = 0.0;
+};
+
+struct HGSContext {
+    const vector<Employee>& instance;
+    const EmployeeIndex& idx;
+    const unordered_map<string, int>& pos;     // employee id -> instance index
+    const vector<Vehicle>& blank;              // fleet before any trip was planned
+    const ObjectiveWeights& w;
+};
+
+// Tries to place instance employee e as a new last pickup of trip `r`.
+bool append_pickup(const Route& r, const Vehicle& v, const Employee& e, const EmployeeIndex& idx,
+                   Route& out) {
+    if (!check_compatibility(v, e, r)) return false;
+    string why;
+    out = r;
+    return insert_pickup(r, e, (int)r.stops.size() - 1, v, idx, out, why);
+}
+
+// Greedy split of a giant tour into trips. Pickups are appended to the open trip
+// in tour order; when the next one does not fit (capacity, category or deadline)
+// a new trip is opened on whichever vehicle starts it cheapest, after that
+// vehicle's last trip. The exact Bellman split does not apply with a
+// heterogeneous, multi-trip fleet, and local search repairs the greedy cuts.
+void split(const HGSContext& hc, Individual& ind) {
+    ind.vehs = hc.blank;
+    ind.obj = SolutionObjective();
+    int open_v = -1;
+
+    for (int i : ind.tour) {
+        const Employee& e = hc.instance[i];
+        Route cand;
+
+        if (open_v >= 0) {
+            Vehicle& v = ind.vehs[open_v];
+            if (append_pickup(v.routes.back(), v, e, hc.idx, cand)) {
+                ind.obj.replace(route_objective(v.routes.back()), route_objective(cand));
+                v.routes.back() = std::move(cand);
+                continue;
+            }
+        }
+
+        int best_v = -1;
+        double best_c = INF;
+        Route best;
+        for (int vi = 0; vi < (int)ind.vehs.size(); vi++) {
+            const Vehicle& v = ind.vehs[vi];
+            const Route slot = v.routes.back().stops.size() <= 2 ? v.routes.back() : make_next_trip(v);
+            if (!append_pickup(slot, v, e, hc.idx, cand)) continue;
+            const double c = route_score(cand, hc.w);
+            if (c < best_c) { best_c = c; best_v = vi; best = std::move(cand); }
+        }
+
+        if (best_v < 0) { ind.obj.unrouted++; continue; }
+        Vehicle& v = ind.vehs[best_v];
+        if (v.routes.back().stops.size() > 2) v.routes.emplace_back();
+        v.routes.back() = std::move(best);
+        ind.obj.add(route_objective(v.routes.back()));
+        open_v = best_v;
+    }
+
+    for (auto& v : ind.vehs) {
+        rechain_trips(v, 0, hc.idx);
+        v.total_cost = vehicle_cost(v);
+    }
+    ind.obj.hash = solution_hash(ind.vehs);     // local search keeps it from here
+}
+
+// Rebuilds tour/succ from the routes; unrouted employees go to the tour's end.
+void encode(const HGSContext& hc, Individual& ind) {
+    const int n = (int)hc.instance.size();
+    ind.tour.clear();
+    ind.succ.assign(n, -2);
+    for (const auto& v : ind.vehs) {
+        for (const auto& r : v.routes) {
+            int prev = -1;
+            for (const auto& s : r.stops) {
+                if (!s.is_pickup()) continue;
+                const int i = hc.pos.at(s.emp_id());
+                ind.tour.push_back(i);
+                ind.succ[i] = -1;
+                if (prev >= 0) ind.succ[prev] = i;
+                prev = i;
+            }
+        }
+    }
+    for (int i = 0; i < n; i++)
+        if (ind.succ[i] == -2) ind.tour.push_back(i);
+}
+
+void educate(const HGSContext& hc, Individual& ind, mt19937& rng, int passes) {
+    relocate_local_search(ind.vehs, hc.idx, hc.w, ind.obj, rng, passes);
+    resequence_trips(ind.vehs, hc.idx, hc.w, ind.obj, true);
+    ind.score = ind.obj.score(hc.w);
+    encode(hc, ind);
+}
+
+// Broken-pair distance: share of employees whose successor differs.
+double broken_pairs(const Individual& a, const Individual& b) {
+    int diff = 0;
+    for (size_t i = 0; i < a.succ.size(); i++) diff += (a.succ[i] != b.succ[i]);
+    return a.succ.empty() ? 0.0 : (double)diff / a.succ.size();
+}
+
+// Order crossover: a random slice of p1 is kept in place, the rest follows p2's order.
+vector<int> crossover_ox(const vector<int>& p1, const vector<int>& p2, mt19937& rng) {
+    const int n = (int)p1.size();
+    vector<int> child(n, -1);
+    if (n == 0) return child;
+    vector<char> used(n, 0);
+    uniform_int_distribution<int> pick(0, n - 1);
+    int a = pick(rng), b = pick(rng);
+    if (a > b) swap(a, b);
+    for (int k = a; k <= b; k++) { child[k] = p1[k]; used[p1[k]] = 1; }
+
+    int out = (b + 1) % n;
+    for (int k = 0; k < n; k++) {
+        const int g = p2[(b + 1 + k) % n];
+        if (used[g]) continue;
+        child[out] = g;
+        out = (out + 1) % n;
+    }
+    return child;
+}
+
+class Population {
+public:
+    Population(const HGSConfig& cfg) : cfg_(cfg) {}
+
+    void add(Individual&& ind) {
+        const size_t n = pop_.size();
+        for (size_t k = 0; k < n; k++) {
+            const double d = broken_pairs(ind, pop_[k]);
+            dist_[k].push_back(d);
+        }
+        dist_.emplace_back(n + 1, 0.0);
+        for (size_t k = 0; k < n; k++) dist_[n][k] = dist_[k][n];
+        pop_.push_back(std::move(ind));
+
+        if ((int)pop_.size() >= cfg_.population + cfg_.generation) select_survivors();
+    }
+
+    const Individual& tournament(mt19937& rng) {
+        update_fitness();
+        uniform_int_distribution<int> pick(0, (int)pop_.size() - 1);
+        const Individual& a = pop_[pick(rng)];
+        const Individual& b = pop_[pick(rng)];
+        return a.fitness < b.fitness ? a : b;
+    }
+
+    const Individual& best() const {
+        return *min_element(pop_.begin(), pop_.end(),
+                            [](const Individual& x, const Individual& y){ return x.score < y.score; });
+    }
+
+    size_t size() const { return pop_.size(); }
+
+    double average_distance() const {
+        double s = 0.0; int c = 0;
+        for (size_t i = 0; i < pop_.size(); i++)
+            for (size_t j = i + 1; j < pop_.size(); j++) { s += dist_[i][j]; c++; }
+        return c ? s / c : 0.0;
+    }
+
+private:
+    // Mean distance to the `close` nearest other individuals.
+    double diversity(size_t k) const {
+        vector<double> d;
+        for (size_t j = 0; j < pop_.size(); j++) if (j != k) d.push_back(dist_[k][j]);
+        const size_t m = min(d.size(), (size_t)max(1, cfg_.close));
+        if (m == 0) return 0.0;
+        partial_sort(d.begin(), d.begin() + m, d.end());
+        return accumulate(d.begin(), d.begin() + m, 0.0) / m;
+    }
+
+    // fitness = cost rank + (1 - elite/n) * diversity rank, both scaled to [0,1].
+    void update_fitness() {
+        const size_t n = pop_.size();
+        if (n <= 1) { for (auto& p : pop_) p.fitness = 0.0; return; }
+        vector<size_t> by_cost(n), by_div(n);
+        vector<double> div(n);
+        for (size_t k = 0; k < n; k++) { by_cost[k] = by_div[k] = k; div[k] = diversity(k); }
+        stable_sort(by_cost.begin(), by_cost.end(), [&](size_t a, size_t b){ return pop_[a].score < pop_[b].score; });
+        stable_sort(by_div.begin(), by_div.end(), [&](size_t a, size_t b){ return div[a] > div[b]; });
+
+        vector<double> cost_rank(n), div_rank(n);
+        for (size_t r = 0; r < n; r++) {
+            cost_rank[by_cost[r]] = (double)r / (n - 1);
+            div_rank[by_div[r]] = (double)r / (n - 1);
+        }
+        const double elite_share = 1.0 - (double)min<size_t>(cfg_.elite, n) / n;
+        for (size_t k = 0; k < n; k++) pop_[k].fitness = cost_rank[k] + elite_share * div_rank[k];
+    }
+
+    void erase(size_t k) {
+        pop_.erase(pop_.begin() + k);
+        dist_.erase(dist_.begin() + k);
+        for (auto& row : dist_) row.erase(row.begin() + k);
+    }
+
+    // Drops clones first, then the worst biased fitness, down to `population`.
+    void select_survivors() {
+        while ((int)pop_.size() > cfg_.population) {
+            update_fitness();
+            size_t worst = 0;
+            bool worst_clone = false;
+            for (size_t k = 0; k < pop_.size(); k++) {
+                bool clone = false;
+                for (size_t j = 0; j < pop_.size(); j++)
+                    if (j != k && dist_[k][j] < 1e-9) { clone = true; break; }
+                if ((clone && !worst_clone) ||
+                    (clone == worst_clone && pop_[k].fitness > pop_[worst].fitness)) {
+                    worst = k;
+                    worst_clone = clone;
+                }
+            }
+            erase(worst);
+        }
+    }
+
+    const HGSConfig& cfg_;
+    vector<Individual> pop_;
+    vector<vector<double>> dist_;
+};
+
+// Initial giant tours: a polar sweep around the office from a random angle, or
+// due_time order with jitter, so early trips group either by area or by shift.
+vector<int> random_tour(const vector<Employee>& inst, mt19937& rng, bool sweep) {
+    vector<int> t(inst.size());
+    iota(t.begin(), t.end(), 0);
+    vector<double> key(inst.size());
+    uniform_real_distribution<double> U(0.0, 1.0);
+    const double start = U(rng) * 2.0 * PI;
+    for (size_t i = 0; i < inst.size(); i++) {
+        if (sweep) {
+            double a = atan2(inst[i].pickup.lat - OFFICE.lat, inst[i].pickup.lng - OFFICE.lng) - start;
+            while (a < 0) a += 2.0 * PI;
+            key[i] = a;
+        } else {
+            key[i] = inst[i].due_time + 30.0 * (U(rng) - 0.5);
+        }
+    }
+    stable_sort(t.begin(), t.end(), [&](int a, int b){ return key[a] < key[b]; });
+    return t;
+}
+
+} // namespace
+
+void run_hgs(vector<Employee>& employees, vector<Vehicle>& vehicles,
+             const HGSConfig& cfg, bool debug) {
+    cout << "--- Hybrid Genetic Search (mu=" << cfg.population << ", lambda=" << cfg.generation << ") ---\n" << endl;
+    auto t_start = chrono::steady_clock::now();
+    auto elapsed = [&]() { return chrono::duration<double>(chrono::steady_clock::now() - t_start).count(); };
+
+    mt19937 rng((unsigned)random_device{}());
+    const ObjectiveWeights w = objective_weights_from_instance();
+    const vector<Employee> instance = employees;
+    const EmployeeIndex idx = build_employee_index(instance);
+    unordered_map<string, int> pos;
+    for (int i = 0; i < (int)instance.size(); i++) pos[instance[i].id] = i;
+    const vector<Vehicle> blank = blank_fleet(vehicles);
+    const HGSContext hc{instance, idx, pos, blank, w};
+
+    Population pop(cfg);
+
+    // The incoming solution is one individual, so HGS never returns anything worse.
+    Individual seed;
+    seed.vehs = vehicles;
+    seed.obj = evaluate_solution(employees, vehicles);
+    educate(hc, seed, rng, cfg.ls_passes);
+    Individual best = seed;
+    pop.add(std::move(seed));
+
+    for (int k = 1; k < cfg.population; k++) {
+        Individual ind;
+        ind.tour = random_tour(instance, rng, k % 2 == 1);
+        split(hc, ind);
+        educate(hc, ind, rng, cfg.ls_passes);
+        if (ind.score < best.score) best = ind;
+        pop.add(std::move(ind));
+    }
+
+    int no_improve = 0;
+    int it = 0;
+    for (it = 1; it <= cfg.iterations; it++) {
+        if (cfg.time_limit_sec > 0.0 && elapsed() > cfg.time_limit_sec) break;
+
+        const Individual& p1 = pop.tournament(rng);
+        const Individual& p2 = pop.tournament(rng);
+        Individual child;
+        child.tour = crossover_ox(p1.tour, p2.tour, rng);
+        split(hc, child);
+        educate(hc, child, rng, cfg.ls_passes);
+
+        if (child.score < best.score - 1e-9) {
+            best = child;
+            no_improve = 0;
+        } else {
+            no_improve++;
+        }
+        pop.add(std::move(child));
+
+        if (debug && it % 100 == 0) {
+            cout << "[HGS] it=" << it << " best=" << fixed << setprecision(2) << best.score
+                 << " pop=" << pop.size() << " div=" << setprecision(3) << pop.average_distance()
+                 << " t=" << setprecision(1) << elapsed() << "s\n";
+        }
+        if (no_improve >= cfg.no_improve_stop) break;
+    }
+
+    cout << "  HGS best score " << fixed << setprecision(2) << best.score << " after " << min(it, cfg.iterations)
+         << " offspring (" << setprecision(1) << elapsed() << "s)\n" << endl;
+
+    vehicles = std::move(best.vehs);
+    for (auto& e : employees) {
+        e.is_routed = best.succ[pos.at(e.id)] != -2;
+        if (e.is_routed) g_unrouted_reason.erase(e.id);
+    }
+}
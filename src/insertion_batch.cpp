@@ -0,0 +1,431 @@
+#include "insertion_batch.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include "compat.h"
+#include "geo.h"
+#include "lateness.h"
+#include "route_cache.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define VELORA_AVX2 1
+#include <immintrin.h>
+#endif
+
+static const double INF_COST = std::numeric_limits<double>::infinity();
+
+void build_trip_soa(const Route& route, const Vehicle& v, TripSoA& t) {
+    const int n = (int)route.stops.size();
+    t.n = n;
+    t.speed_kmh = v.speed_kmh;
+    t.cost_per_km = v.cost_per_km;
+    t.base_km = 0.0;
+    t.passengers = 0;
+    t.hard_deadline = route.late.hard_deadline;
+    t.late = &route.late;
+    t.node.resize(n);
+    t.ready.resize(n);
+    t.dep.resize(n);
+    t.leg_km.resize(n);
+    t.leg_min.resize(n);
+    t.wait_prefix.resize(n);
+    t.dep_prefix.resize(n);
+
+    // finalize_route() keeps the leg lengths; only a trip it never saw pays for them.
+    const bool legs_known = (int)route.leg_km.size() == n;
+    int wait_sum = 0, dep_sum = 0;
+    for (int j = 0; j < n; j++) {
+        const Stop& s = route.stops[j];
+        t.node[j] = s.node;
+        t.ready[j] = s.is_pickup() ? g_nodes.ready[s.node] : 0;
+        t.dep[j] = s.departure_time;
+        if (legs_known) t.leg_km[j] = route.leg_km[j];
+        else t.leg_km[j] = j ? get_dist(route.stops[j - 1].loc(), s.loc()) : 0.0;
+        t.leg_min[j] = j ? travel_minutes(t.leg_km[j], v.speed_kmh) : 0;
+        t.base_km += t.leg_km[j];
+        t.wait_prefix[j] = wait_sum;
+        t.dep_prefix[j] = dep_sum;
+        if (s.is_pickup()) {
+            t.passengers++;
+            wait_sum += s.begin_service - s.arrival_time;
+            dep_sum += s.departure_time;
+        }
+    }
+}
+
+// ------------------------------------------------------------
+// Timing kernels. A lane is one (employee, position p) pair: insertion before
+// stop P[l]. It enters with the departure it would have from stop p-1 if the
+// leg into p were unchanged (D), and the wait / departure sums of everything
+// before p plus the new pickup (W, S). Stop j then re-times only the lanes with
+// p <= j; END gives the office time. Lanes of any number of employees can
+// share a pass since only D, W and S depend on the employee.
+// ------------------------------------------------------------
+static void time_lanes_scalar(const TripSoA& t, int lanes, const int* P, int* D, int* W, int* S, int* office) {
+    const int n = t.n;
+    for (int l = 0; l < lanes; l++) {
+        int d = D[l], w = W[l], s = S[l];
+        for (int j = P[l]; j + 1 < n; j++) {
+            const int arr = d + t.leg_min[j];
+            const int begin = std::max(arr, t.ready[j]);
+            w += begin - arr;
+            d = begin + SERVICE_PICKUP_MIN;
+            s += d;
+        }
+        W[l] = w;
+        S[l] = s;
+        office[l] = d + t.leg_min[n - 1];
+    }
+}
+
+#ifdef VELORA_AVX2
+// Lane arrays are padded to whole blocks of 8; padding lanes have P = n.
+__attribute__((target("avx2")))
+static void time_lanes_avx2(const TripSoA& t, int lanes, const int* P, int* D, int* W, int* S, int* office) {
+    const int n = t.n;
+    const __m256i service = _mm256_set1_epi32(SERVICE_PICKUP_MIN);
+    const __m256i to_end = _mm256_set1_epi32(t.leg_min[n - 1]);
+    for (int base = 0; base < lanes; base += 8) {
+        const __m256i pos = _mm256_loadu_si256((const __m256i*)(P + base));
+        const int first = *std::min_element(P + base, P + base + 8);
+        __m256i d = _mm256_loadu_si256((const __m256i*)(D + base));
+        __m256i w = _mm256_loadu_si256((const __m256i*)(W + base));
+        __m256i s = _mm256_loadu_si256((const __m256i*)(S + base));
+        for (int j = first; j + 1 < n; j++) {
+            const __m256i waiting = _mm256_cmpgt_epi32(pos, _mm256_set1_epi32(j));   // p > j: not yet
+            const __m256i arr = _mm256_add_epi32(d, _mm256_set1_epi32(t.leg_min[j]));
+            const __m256i begin = _mm256_max_epi32(arr, _mm256_set1_epi32(t.ready[j]));
+            const __m256i nd = _mm256_add_epi32(begin, service);
+            w = _mm256_blendv_epi8(_mm256_add_epi32(w, _mm256_sub_epi32(begin, arr)), w, waiting);
+            s = _mm256_blendv_epi8(_mm256_add_epi32(s, nd), s, waiting);
+            d = _mm256_blendv_epi8(nd, d, waiting);
+        }
+        _mm256_storeu_si256((__m256i*)(W + base), w);
+        _mm256_storeu_si256((__m256i*)(S + base), s);
+        _mm256_storeu_si256((__m256i*)(office + base), _mm256_add_epi32(d, to_end));
+    }
+}
+
+static bool g_simd = __builtin_cpu_supports("avx2");
+#else
+static bool g_simd = false;
+#endif
+
+bool insertion_simd_enabled() { return g_simd; }
+
+void insertion_simd_configure(bool enabled) {
+#ifdef VELORA_AVX2
+    g_simd = enabled && __builtin_cpu_supports("avx2");
+#else
+    (void)enabled;
+    g_simd = false;
+#endif
+}
+
+void price_insertions_block(const TripSoA& t, const Employee* const* emps, int m,
+                            const ObjectiveWeights& w, double* cost) {
+    const int n = t.n;
+    if (n < 2) return;
+
+    // One lane per (employee, position), padded to a whole AVX2 block.
+    int priced = 0;
+    for (int e = 0; e < m; e++) priced += emps[e] != nullptr;
+    const int lanes = priced * (n - 1);
+    const size_t padded = (size_t)lanes + 8;
+    static thread_local std::vector<int> P, D, W, S, office;
+    static thread_local std::vector<double> d_in, d_out;
+    P.resize(padded);
+    D.resize(padded);
+    W.resize(padded);
+    S.resize(padded);
+    office.resize(padded);
+    d_in.resize(lanes);
+    d_out.resize(lanes);
+
+    int l = 0;
+    for (int e = 0; e < m; e++) {
+        if (!emps[e]) continue;
+        const Employee& emp = *emps[e];
+        const Location& at = g_nodes.locs[emp.index];
+        for (int p = 1; p < n; p++, l++) {
+            const Location& prev = g_nodes.locs[t.node[p - 1]];
+            const Location& next = g_nodes.locs[t.node[p]];
+            d_in[l] = get_dist(prev, at);
+            d_out[l] = get_dist(at, next);
+            const int arr = t.dep[p - 1] + travel_minutes(d_in[l], t.speed_kmh);
+            const int begin = std::max(arr, emp.ready_time);
+            const int dep = begin + SERVICE_PICKUP_MIN;
+            P[l] = p;
+            D[l] = dep + travel_minutes(d_out[l], t.speed_kmh) - t.leg_min[p];
+            W[l] = t.wait_prefix[p] + (begin - arr);
+            S[l] = t.dep_prefix[p] + dep;
+        }
+    }
+    std::fill(P.begin() + lanes, P.end(), n);
+    std::fill(D.begin() + lanes, D.end(), 0);
+    std::fill(W.begin() + lanes, W.end(), 0);
+    std::fill(S.begin() + lanes, S.end(), 0);
+
+#ifdef VELORA_AVX2
+    if (g_simd) time_lanes_avx2(t, lanes, P.data(), D.data(), W.data(), S.data(), office.data());
+    else
+#endif
+        time_lanes_scalar(t, lanes, P.data(), D.data(), W.data(), S.data(), office.data());
+
+    l = 0;
+    for (int e = 0; e < m; e++) {
+        if (!emps[e]) continue;
+        const Employee& emp = *emps[e];
+        double* row = cost + (size_t)e * n;
+        row[0] = INF_COST;
+        const int deadline = std::min(t.hard_deadline, hard_due(emp));
+        for (int p = 1; p < n; p++, l++) {
+            const int end = office[l];
+            if (end > deadline) {
+                row[p] = INF_COST;
+                continue;
+            }
+            const double km = t.base_km - t.leg_km[p] + d_in[l] + d_out[l];
+            const double late = profile_penalty(*t.late, end) + lateness_penalty(emp, end);
+            const int ride = (t.passengers + 1) * end - S[l];
+            row[p] = w.cost * (km * t.cost_per_km + late) + w.ride * (double)ride + w.wait * (double)W[l];
+        }
+    }
+}
+
+void price_insertions(const TripSoA& t, const Employee& emp, const ObjectiveWeights& w,
+                      const unsigned char* skip, double* cost) {
+    cost[0] = INF_COST;
+    const Employee* one = &emp;
+    price_insertions_block(t, &one, 1, w, cost);
+    if (skip)
+        for (int p = 1; p < t.n; p++)
+            if (skip[p]) cost[p] = INF_COST;
+}
+
+// ------------------------------------------------------------
+// Best insertion
+// ------------------------------------------------------------
+bool best_insert_scalar(Route& route, const Vehicle& vehicle, const Employee& emp,
+                        const EmployeeIndex& idx, const ObjectiveWeights& w,
+                        double blink_rate, std::mt19937* rng) {
+    // Try all insertion positions between index 1..(n-1) so START/END stay fixed.
+    // Each candidate only re-times the stops after the insertion point.
+    int n = (int)route.stops.size();
+    if (n < 2) return false;
+    if (!check_compatibility(vehicle, emp, route)) return false;
+
+    double best_cost = INF_COST;
+    Route best;
+    Route cand = route;
+    static thread_local std::string why;   // reused: failure reasons would allocate per call
+    std::uniform_real_distribution<double> U01(0.0, 1.0);
+
+    for (int pos = 1; pos <= n-1; pos++) {
+        if (rng && U01(*rng) < blink_rate) continue;
+        if (!insert_pickup(route, emp, pos, vehicle, idx, cand, why)) continue;
+
+        const double c = route_score(cand, w);
+        if (c < best_cost) {
+            best_cost = c;
+            best = cand;
+        }
+    }
+
+    if (!std::isfinite(best_cost)) return false;
+
+    route = std::move(best);
+    return true;
+}
+
+bool best_insert_batch(Route& route, const Vehicle& vehicle, const Employee& emp,
+                       const EmployeeIndex& idx, const ObjectiveWeights& w,
+                       double blink_rate, std::mt19937* rng) {
+    const int n = (int)route.stops.size();
+    if (n <= 2) return best_insert_scalar(route, vehicle, emp, idx, w, blink_rate, rng);  // one position
+    if (!check_compatibility(vehicle, emp, route)) return false;
+
+    static thread_local TripSoA soa;
+    static thread_local std::vector<double> cost;
+    build_trip_soa(route, vehicle, soa);
+    cost.resize(n);
+    price_insertions(soa, emp, w, nullptr, cost.data());
+    return best_insert_priced(route, vehicle, emp, idx, w, cost.data(), blink_rate, rng);
+}
+
+bool best_insert_priced(Route& route, const Vehicle& vehicle, const Employee& emp,
+                        const EmployeeIndex& idx, const ObjectiveWeights& w, const double* prices,
+                        double blink_rate, std::mt19937* rng) {
+    // Blinks are drawn per position in order, as the scalar scan draws them.
+    const int n = (int)route.stops.size();
+    static thread_local std::vector<double> cost;
+    cost.assign(prices, prices + n);
+    if (rng) {
+        std::uniform_real_distribution<double> U01(0.0, 1.0);
+        for (int pos = 1; pos <= n - 1; pos++)
+            if (U01(*rng) < blink_rate) cost[pos] = INF_COST;
+    }
+
+    const double lowest = *std::min_element(cost.begin(), cost.end());
+    if (!std::isfinite(lowest)) return false;
+
+    // Batch scores can be off in the last bits; every position that might be
+    // the scalar minimum is re-scored exactly, in position order.
+    const double tol = 1e-7 * (1.0 + std::fabs(lowest));
+    double best_cost = INF_COST;
+    Route best;
+    Route cand = route;
+    static thread_local std::string why;
+    for (int pos = 1; pos <= n - 1; pos++) {
+        if (cost[pos] > lowest + tol) continue;
+        if (!insert_pickup(route, emp, pos, vehicle, idx, cand, why)) continue;
+        const double c = route_score(cand, w);
+        if (c < best_cost) {
+            best_cost = c;
+            best = cand;
+        }
+    }
+    if (!std::isfinite(best_cost)) return false;
+
+    route = std::move(best);
+    return true;
+}
+
+// ------------------------------------------------------------
+// Microbenchmark
+// ------------------------------------------------------------
+void bench_insertion(const std::vector<Employee>& employees, const std::vector<Vehicle>& vehicles) {
+    using clock = std::chrono::steady_clock;
+    const EmployeeIndex idx = build_employee_index(employees);
+    const ObjectiveWeights w = objective_weights_from_instance();
+
+    // Trips of the plan, plus each vehicle's trips merged into one to reach
+    // lengths beyond a single trip's seats. Seat and pairing limits are lifted
+    // (both evaluators would reject those cases up front, which is not what is
+    // being timed); the vehicle category still has to fit.
+    std::vector<std::pair<Vehicle, Route>> trips;
+    for (const auto& v : vehicles) {
+        Vehicle bare = v;
+        bare.routes.clear();
+        bare.capacity = 99;
+        Route merged;
+        for (const auto& r : v.routes) {
+            if (r.stops.size() <= 2) continue;
+            trips.push_back({bare, r});
+            if (merged.stops.empty()) merged = r;
+            else merged.stops.insert(merged.stops.end() - 1, r.stops.begin() + 1, r.stops.end() - 1);
+        }
+        if (merged.stops.size() > 2 && merged.stops.size() != trips.back().second.stops.size()) {
+            simulate_route(merged, bare, idx);
+            trips.push_back({bare, merged});
+        }
+    }
+    for (auto& [v, r] : trips) r.max_capacity = 99;
+    std::vector<uint64_t> pairs;
+    pairs.swap(g_compat.pair);
+    // Repeats would be route cache hits on every path but the block one.
+    const size_t cache_capacity = route_cache_stats().capacity;
+    route_cache_configure(0);
+
+    struct Case { int trip; const Employee* emp; };
+    std::map<int, std::vector<Case>> by_len;
+    for (int ti = 0; ti < (int)trips.size(); ti++) {
+        const auto& [v, r] = trips[ti];
+        int taken = 0;
+        for (size_t k = 0; k < employees.size() && taken < 32; k++) {
+            const Employee& e = employees[(k * 7919 + ti * 31) % employees.size()];
+            if (!check_compatibility(v, e, r)) continue;
+            bool aboard = false;
+            for (const auto& s : r.stops) aboard = aboard || s.node == e.index;
+            if (aboard) continue;
+            by_len[r.current_capacity].push_back({ti, &e});
+            taken++;
+        }
+    }
+
+    const bool simd_available = insertion_simd_enabled();
+    auto run = [&](const std::vector<Case>& cases, int reps, int mode, std::vector<Route>* out) {
+        const auto t0 = clock::now();
+        for (int rep = 0; rep < reps; rep++) {
+            for (size_t c = 0; c < cases.size(); c++) {
+                const auto& [v, trip] = trips[cases[c].trip];
+                Route r = trip;
+                const bool ok = mode == 0 ? best_insert_scalar(r, v, *cases[c].emp, idx, w)
+                                          : best_insert_batch(r, v, *cases[c].emp, idx, w);
+                if (!ok) r.stops.clear();
+                if (out && rep == 0) (*out)[c] = std::move(r);
+            }
+        }
+        return std::chrono::duration<double, std::micro>(clock::now() - t0).count() / (reps * (double)cases.size());
+    };
+    // Cases of one trip are adjacent: each run of them is priced as one block.
+    auto run_block = [&](const std::vector<Case>& cases, int reps, std::vector<Route>* out) {
+        TripSoA soa;
+        std::vector<const Employee*> emps;
+        std::vector<double> cost;
+        const auto t0 = clock::now();
+        for (int rep = 0; rep < reps; rep++) {
+            for (size_t lo = 0, hi; lo < cases.size(); lo = hi) {
+                for (hi = lo; hi < cases.size() && cases[hi].trip == cases[lo].trip; hi++) {}
+                const auto& [v, trip] = trips[cases[lo].trip];
+                build_trip_soa(trip, v, soa);
+                emps.clear();
+                for (size_t c = lo; c < hi; c++) emps.push_back(cases[c].emp);
+                cost.resize(emps.size() * soa.n);
+                price_insertions_block(soa, emps.data(), (int)emps.size(), w, cost.data());
+                for (size_t c = lo; c < hi; c++) {
+                    Route r = trip;
+                    if (!best_insert_priced(r, v, *cases[c].emp, idx, w, cost.data() + (c - lo) * soa.n))
+                        r.stops.clear();
+                    if (out && rep == 0) (*out)[c] = std::move(r);
+                }
+            }
+        }
+        return std::chrono::duration<double, std::micro>(clock::now() - t0).count() / (reps * (double)cases.size());
+    };
+
+    std::cout << "\n--- Insertion pricing benchmark (" << (simd_available ? "AVX2" : "no AVX2")
+              << "; us per employee x trip, all positions) ---\n";
+    std::cout << std::setw(10) << "passengers" << std::setw(8) << "cases"
+              << std::setw(10) << "scalar" << std::setw(12) << "batch-1x"
+              << std::setw(12) << "batch-avx2" << std::setw(12) << "block" << std::setw(10) << "speedup"
+              << std::setw(12) << "mismatches" << "\n";
+    for (const auto& [len, cases] : by_len) {
+        const int reps = std::max(1, 20000 / (int)cases.size());
+        std::vector<Route> ref(cases.size()), got_plain(cases.size()), got_simd(cases.size()),
+            got_block(cases.size());
+        const double t_scalar = run(cases, reps, 0, &ref);
+        insertion_simd_configure(false);
+        const double t_plain = run(cases, reps, 1, &got_plain);
+        insertion_simd_configure(simd_available);
+        const double t_simd = simd_available ? run(cases, reps, 1, &got_simd) : t_plain;
+        if (!simd_available) got_simd = got_plain;
+        const double t_block = run_block(cases, reps, &got_block);
+
+        int mismatches = 0;
+        auto same = [&](const Route& a, const Route& b) {
+            if (a.stops.size() != b.stops.size()) return false;
+            for (size_t i = 0; i < a.stops.size(); i++)
+                if (a.stops[i].node != b.stops[i].node || a.stops[i].departure_time != b.stops[i].departure_time)
+                    return false;
+            return a.stops.empty() || route_score(a, w) == route_score(b, w);
+        };
+        for (size_t c = 0; c < cases.size(); c++)
+            mismatches += !same(ref[c], got_plain[c]) + !same(ref[c], got_simd[c]) + !same(ref[c], got_block[c]);
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(10) << len << std::setw(8) << cases.size()
+                  << std::setw(10) << t_scalar << std::setw(12) << t_plain
+                  << std::setw(12) << t_simd << std::setw(12) << t_block
+                  << std::setw(9) << t_scalar / std::min({t_plain, t_simd, t_block}) << "x"
+                  << std::setw(12) << mismatches << "\n";
+    }
+    std::cout << std::defaultfloat;
+    pairs.swap(g_compat.pair);
+    route_cache_configure(cache_capacity);
+}
@@ -0,0 +1,105 @@
+#include "instance_store.h"
+#include <algorithm>
+#include "compat.h"
+#include "lateness.h"
+
+using namespace std;
+
+int employee_index_space(const vector<Employee>& emps) {
+    int n = 0;
+    for (const auto& e : emps) n = max(n, e.index + 1);
+    return n;
+}
+
+InstanceStore build_instance_store(const vector<Employee>& emps) {
+    InstanceStore s;
+    s.n = employee_index_space(emps);
+    s.lat.resize(s.n);
+    s.lng.resize(s.n);
+    s.ready.resize(s.n);
+    s.due.resize(s.n);
+    s.hard_due.resize(s.n);
+    s.veh_pref.resize(s.n);
+    s.cold.assign(s.n, nullptr);
+    s.members.reserve(emps.size());
+    for (const Employee& e : emps) {
+        const int i = e.index;
+        s.members.push_back(i);
+        s.lat[i] = e.pickup.lat;
+        s.lng[i] = e.pickup.lng;
+        s.ready[i] = e.ready_time;
+        s.due[i] = e.due_time;
+        s.hard_due[i] = hard_due(e);
+        s.veh_pref[i] = (uint8_t)e.veh_pref;
+        s.cold[i] = &e;
+    }
+    return s;
+}
+
+void SolutionState::place_trip(const Route& r, int vi, int ri) {
+    int size = 0;
+    for (int p = 0; p < (int)r.stops.size(); p++)
+        if (r.stops[p].is_pickup()) { at[r.stops[p].node] = {vi, ri, p}; size++; }
+
+    // Size bucket: swap-remove from the old one, append to the new one.
+    if ((int)trip_slot.size() <= vi) trip_slot.resize(vi + 1);
+    if ((int)trip_slot[vi].size() <= ri) trip_slot[vi].resize(ri + 1);
+    TripSlot& slot = trip_slot[vi][ri];
+    if (slot.size != size) {
+        if (slot.pos >= 0) {
+            auto& from = trips_by_size[slot.size];
+            const TripRef moved = from.back();
+            from[slot.pos] = moved;
+            trip_slot[moved.vi][moved.ri].pos = slot.pos;
+            from.pop_back();
+            slot.pos = -1;
+        }
+        slot.size = size;
+        if (size > 0) {
+            if ((int)trips_by_size.size() <= size) trips_by_size.resize(size + 1);
+            slot.pos = (int)trips_by_size[size].size();
+            trips_by_size[size].push_back({vi, ri});
+        }
+    }
+
+    if (g_compat.words == 0) return;
+    const size_t stride = 1 + (size_t)g_compat.words;
+    if ((int)trip_compat.size() <= vi) trip_compat.resize(vi + 1);
+    auto& rows = trip_compat[vi];
+    if (rows.size() < (ri + 1) * stride) rows.resize((ri + 1) * stride, 0);
+    uint64_t* row = rows.data() + ri * stride;
+    row[0] = r.hash;
+    build_trip_compat(r.stops, row + 1);
+}
+
+const uint64_t* SolutionState::trip_mask(const Route& r, int vi, int ri) const {
+    // Route::hash is 0 only before the first finalize_route(), like unused rows.
+    if (r.hash == 0 || vi >= (int)trip_compat.size()) return nullptr;
+    const size_t stride = 1 + (size_t)g_compat.words;
+    const auto& rows = trip_compat[vi];
+    if ((ri + 1) * stride > rows.size() || rows[ri * stride] != r.hash) return nullptr;
+    return rows.data() + ri * stride + 1;
+}
+
+SolutionState build_solution_state(const vector<Employee>& emps, const vector<Vehicle>& vehicles) {
+    SolutionState st;
+    const int n = employee_index_space(emps);
+    st.routed.assign(n, 0);
+    st.at.assign(n, Placement());
+    for (const auto& e : emps) st.routed[e.index] = e.is_routed ? 1 : 0;
+    for (int vi = 0; vi < (int)vehicles.size(); vi++)
+        for (int ri = 0; ri < (int)vehicles[vi].routes.size(); ri++)
+            st.place_trip(vehicles[vi].routes[ri], vi, ri);
+    return st;
+}
+
+void sync_placements(SolutionState& st, const vector<Vehicle>& vehicles) {
+    for (int vi = 0; vi < (int)vehicles.size(); vi++)
+        for (int ri = 0; ri < (int)vehicles[vi].routes.size(); ri++)
+            if (vehicles[vi].routes[ri].removal_gain_stale) st.place_trip(vehicles[vi].routes[ri], vi, ri);
+}
+
+void store_routed_flags(const SolutionState& st, vector<Employee>& emps) {
+    for (auto& e : emps)
+        if (e.index >= 0 && e.index < (int)st.routed.size()) e.is_routed = st.routed[e.index] != 0;
+}
@@ -1,4 +1,6 @@
 #include "io.h"
+#include "compat.h"
+#include "route_eval.h"
 #include "mini_json.h"
 #include "time_utils.h"
 #include "config.h"
@@ -6,6 +8,8 @@
 #include <sstream>
 #include <iostream>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
 
 using namespace std;
 using Json = mini_json::Value;
@@ -24,6 +28,43 @@ using Json = mini_json::Value;
     return ANY_SHARE;
 }
 
+Employee parse_employee(const string& id, const Json& data) {
+    Employee e;
+    e.id = id;
+    e.priority = data["priority"].as_int(999);
+    e.pickup = {data["pickup"]["lat"].as_number(), data["pickup"]["lng"].as_number()};
+    e.drop   = {data["drop"]["lat"].as_number(),  data["drop"]["lng"].as_number()};
+
+    // FIX: Handle decimal day fractions for earliest_pickup
+    const Json& earliest_pickup_json = data["earliest_pickup"];
+    if (earliest_pickup_json.is_number()) {
+        // Convert day fraction to minutes: fraction * 24 * 60
+        double day_fraction = earliest_pickup_json.as_number();
+        e.ready_time = (int)llround(day_fraction * 24.0 * 60.0);
+    } else {
+        // Fallback to string parsing
+        e.ready_time = parse_time(data["earliest_pickup"].as_string("08:00"));
+    }
+
+    // FIX: Handle decimal day fractions for latest_drop
+    const Json& latest_drop_json = data["latest_drop"];
+    if (latest_drop_json.is_number()) {
+        // Convert day fraction to minutes: fraction * 24 * 60
+        double day_fraction = latest_drop_json.as_number();
+        e.due_time = (int)llround(day_fraction * 24.0 * 60.0);
+    } else {
+        // Fallback to string parsing
+        e.due_time = parse_time(data["latest_drop"].as_string("23:59"));
+    }
+
+    e.veh_pref   = parse_vehicle_category(data["vehicle_preference"].as_string("any"));
+    e.share_pref = parse_sharing_pref(data["sharing_preference"].as_string("any"));
+    e.is_routed = false;
+    e.baseline_cost = data["baseline_cost"].as_number(0.0);
+    e.baseline_time = data["baseline_time_min"].as_number(0.0);
+    return e;
+}
+
 bool load_from_json(const string& filename, vector<Employee>& emps, vector<Vehicle>& vehs) {
     try {
         ifstream file(filename);
@@ -45,6 +86,8 @@ bool load_from_json(const string& filename, vector<Employee>& emps, vector<Vehic
         };
 
         map<string, double> baseline_map;
+        map<string, double> baseline_time_map;
+        double baseline_cost_sum = 0.0, baseline_time_sum = 0.0;
         if (has_key(data, "baseline")) {
             const Json& base = data["baseline"];
             if (base.is_array()) {
@@ -52,10 +95,48 @@ bool load_from_json(const string& filename, vector<Employee>& emps, vector<Vehic
                     if (!b.is_object()) continue;
                     std::string eid = b["employee_id"].as_string();
                     double bc = b["baseline_cost"].as_number(0.0);
-                    if (!eid.empty()) baseline_map[eid] = bc;
+                    double bt = b["baseline_time_min"].as_number(0.0);
+                    if (!eid.empty()) {
+                        baseline_map[eid] = bc;
+                        baseline_time_map[eid] = bt;
+                        baseline_cost_sum += bc;
+                        baseline_time_sum += bt;
+                    }
                 }
             }
         }
+        if (baseline_cost_sum > 0.0 && baseline_time_sum > 0.0) {
+            TIME_VALUE_PER_MIN = baseline_cost_sum / baseline_time_sum;
+        }
+
+        // Load metadata (array of {key, value}); values may be numbers or strings.
+        double meta_late_rate = -1.0;
+        if (has_key(data, "metadata")) {
+            const Json& meta = data["metadata"];
+            if (meta.is_array()) {
+                for (const auto& m : meta.arr) {
+                    if (!m.is_object()) continue;
+                    std::string key = m["key"].as_string();
+                    const Json& val = m["value"];
+                    double num = val.is_number() ? val.as_number() : std::atof(val.as_string("0").c_str());
+
+                    int p = 0;
+                    if (sscanf(key.c_str(), "priority_%d_max_delay_min", &p) == 1 && p >= 1 && p <= 5) {
+                        PRIORITY_MAX_DELAY[p] = (int)llround(num);
+                    } else if (sscanf(key.c_str(), "priority_%d_late_weight", &p) == 1 && p >= 1 && p <= 5) {
+                        PRIORITY_LATE_WEIGHT[p] = num;
+                    } else if (key == "lateness_penalty_per_min") {
+                        meta_late_rate = num;
+                    } else if (key == "objective_cost_weight") {
+                        OBJ_COST_WEIGHT = num;
+                    } else if (key == "objective_time_weight") {
+                        OBJ_TIME_WEIGHT = num;
+                    }
+                }
+            }
+        }
+        if (LATENESS_PENALTY_PER_MIN < 0.0)
+            LATENESS_PENALTY_PER_MIN = meta_late_rate >= 0.0 ? meta_late_rate : TIME_VALUE_PER_MIN;
 
         // Load employees
         if (has_key(data, "employees")) {
@@ -65,49 +146,21 @@ bool load_from_json(const string& filename, vector<Employee>& emps, vector<Vehic
                 string emp_id = kv.first;
                 const Json& emp_data = kv.second;
                 
-                Employee e;
-                e.id = emp_id;
-                e.priority = emp_data["priority"].as_int(999);
-                e.pickup = {emp_data["pickup"]["lat"].as_number(), emp_data["pickup"]["lng"].as_number()};
-                e.drop   = {emp_data["drop"]["lat"].as_number(),  emp_data["drop"]["lng"].as_number()};
-                
+                Employee e = parse_employee(emp_id, emp_data);
                 // Set global OFFICE from the first employee drop location (assumed common for all)
                 if (OFFICE.lat == 0.0 && OFFICE.lng == 0.0) {
                     OFFICE = e.drop;
                 }
-                
-                // FIX: Handle decimal day fractions for earliest_pickup
-                const Json& earliest_pickup_json = emp_data["earliest_pickup"];
-                if (earliest_pickup_json.is_number()) {
-                    // Convert day fraction to minutes: fraction * 24 * 60
-                    double day_fraction = earliest_pickup_json.as_number();
-                    e.ready_time = (int)llround(day_fraction * 24.0 * 60.0);
-                } else {
-                    // Fallback to string parsing
-                    e.ready_time = parse_time(emp_data["earliest_pickup"].as_string("08:00"));
-                }
-                
-                // FIX: Handle decimal day fractions for latest_drop
-                const Json& latest_drop_json = emp_data["latest_drop"];
-                if (latest_drop_json.is_number()) {
-                    // Convert day fraction to minutes: fraction * 24 * 60
-                    double day_fraction = latest_drop_json.as_number();
-                    e.due_time = (int)llround(day_fraction * 24.0 * 60.0);
-                } else {
-                    // Fallback to string parsing
-                    e.due_time = parse_time(emp_data["latest_drop"].as_string("23:59"));
-                }
-                
-                e.veh_pref   = parse_vehicle_category(emp_data["vehicle_preference"].as_string("any"));
-                e.share_pref = parse_sharing_pref(emp_data["sharing_preference"].as_string("any"));
-                e.is_routed = false;
                 e.baseline_cost = baseline_map.count(emp_id) ? baseline_map[emp_id] : 0;
+                e.baseline_time = baseline_time_map.count(emp_id) ? baseline_time_map[emp_id] : 0;
+                e.index = (int)emps.size();
                 
                 emps.push_back(e);
             }
         }
 
         cout << "  Loaded " << emps.size() << " employees" << endl;
+        cout << "  Lateness: Rs." << LATENESS_PENALTY_PER_MIN << " per late minute x priority weight" << endl;
 
         // Load vehicles
         if (has_key(data, "vehicles")) {
@@ -122,8 +175,7 @@ bool load_from_json(const string& filename, vector<Employee>& emps, vector<Vehic
                 v.speed_kmh = veh_data["avg_speed_kmph"].as_number(30.0);
                 v.depot_loc = {veh_data["current_lat"].as_number(), veh_data["current_lng"].as_number()};
 
-                // Trip #1 starts from vehicle start (dataset)
-                v.current_loc = v.depot_loc;
+                // Trip #1 starts from vehicle start (dataset): see build_node_table().
                 
                 // FIX: Also handle vehicle available_from as decimal day fraction
                 const Json& available_json = veh_data["available_from"];
@@ -142,6 +194,8 @@ bool load_from_json(const string& filename, vector<Employee>& emps, vector<Vehic
         }
 
         cout << "  Loaded " << vehs.size() << " vehicles\n" << endl;
+        build_compat(emps, vehs);
+        build_node_table(emps, vehs);
         return true;
 
     } catch (const exception& e) {
@@ -188,6 +242,7 @@ bool load_from_json_keep_root(
         e.share_pref = parse_sharing_pref(je["share_pref"].as_string());
         e.is_routed = false;
         e.baseline_cost = je["baseline_cost"].as_number(0.0);
+        e.index = (int)emps.size();
         emps.push_back(e);
     }
 
@@ -206,12 +261,13 @@ bool load_from_json_keep_root(
         v.available_time = parse_time(jv["available_time"].as_string());
         v.depot_loc.lat = jv["start"]["lat"].as_number();
         v.depot_loc.lng = jv["start"]["lng"].as_number();
-        v.current_loc = v.depot_loc;
         v.total_cost = 0.0;
         v.routes.clear();
         vehs.push_back(v);
     }
 
+    build_compat(emps, vehs);
+    build_node_table(emps, vehs);
     return true;
 }
 
@@ -1,5 +1,7 @@
 #include "json_serialize.h"
+#include <cmath>
 #include <iomanip>
+#include <sstream>
 
 static void indent(std::ostream& os, int n) {
     for (int i = 0; i < n; i++) os << ' ';
@@ -64,3 +66,40 @@ void write_json(std::ostream& os, const mini_json::Value& v, int ind) {
         }
     }
 }
+
+void write_json_line(std::ostream& os, const mini_json::Value& v) {
+    using T = mini_json::Value::Type;
+
+    switch (v.type) {
+        case T::Array:
+            os << "[";
+            for (size_t i = 0; i < v.arr.size(); i++) {
+                if (i) os << ",";
+                write_json_line(os, v.arr[i]);
+            }
+            os << "]";
+            return;
+        case T::Object: {
+            os << "{";
+            size_t i = 0;
+            for (const auto& kv : v.obj) {
+                if (i++) os << ",";
+                os << "\"" << escape_json_str(kv.first) << "\":";
+                write_json_line(os, kv.second);
+            }
+            os << "}";
+            return;
+        }
+        case T::Number: {
+            // Independent of the stream's float format; whole numbers print as integers.
+            std::ostringstream num;
+            if (v.num == std::floor(v.num) && std::fabs(v.num) < 1e15) num << (long long)v.num;
+            else num << std::setprecision(10) << v.num;
+            os << num.str();
+            return;
+        }
+        default:
+            write_json(os, v, 0);
+            return;
+    }
+}
@@ -0,0 +1,96 @@
+#include "lateness.h"
+#include "config.h"
+#include <algorithm>
+
+int priority_class(const Employee& e) {
+    if (e.priority < 1) return 1;
+    if (e.priority > 5) return 5;
+    return e.priority;
+}
+
+int max_delay_min(const Employee& e) {
+    return PRIORITY_MAX_DELAY[priority_class(e)];
+}
+
+int hard_due(const Employee& e) {
+    return e.due_time + max_delay_min(e);
+}
+
+double late_rate_per_min(const Employee& e) {
+    return LATENESS_PENALTY_PER_MIN * PRIORITY_LATE_WEIGHT[priority_class(e)];
+}
+
+double lateness_penalty(const Employee& e, int office_arrival) {
+    if (office_arrival <= e.due_time) return 0.0;
+    return late_rate_per_min(e) * (double)(office_arrival - e.due_time);
+}
+
+static const Employee* find_member(const MemberList& members, int node) {
+    for (const Employee* e : members)
+        if (e->index == node) return e;
+    return nullptr;
+}
+
+void update_lateness_profile(LatenessProfile& prof, const MemberList& members) {
+    const size_t k = members.size();
+    bool same = prof.node.size() == k;
+    for (size_t i = 0; same && i < k; i++) same = find_member(members, prof.node[i]) != nullptr;
+    if (same && prof.rate_prefix.size() == k + 1) return;
+
+    // Keep the passengers still aboard in their due order, then insert the new ones.
+    MemberList sorted;
+    for (int node : prof.node)
+        if (const Employee* e = find_member(members, node)) sorted.push_back(e);
+    for (const Employee* e : members) {
+        bool known = false;
+        for (const Employee* s : sorted) known = known || s == e;
+        if (known) continue;
+        size_t pos = sorted.size();
+        while (pos > 0 && sorted[pos - 1]->due_time > e->due_time) pos--;
+        sorted.insert(sorted.begin() + pos, e);
+    }
+
+    prof.hard_deadline = INT_MAX;
+    prof.anchor = 0;
+    prof.node.resize(k);
+    prof.due.resize(k);
+    prof.rate_prefix.assign(k + 1, 0.0);
+    prof.rate_due_prefix.assign(k + 1, 0.0);
+    prof.due_prefix.assign(k + 1, 0);
+
+    for (size_t i = 0; i < k; i++) {
+        const Employee& e = *sorted[i];
+        const double rate = late_rate_per_min(e);
+        prof.hard_deadline = std::min(prof.hard_deadline, hard_due(e));
+        prof.node[i] = e.index;
+        prof.due[i] = e.due_time;
+        prof.rate_prefix[i + 1] = prof.rate_prefix[i] + rate;
+        prof.rate_due_prefix[i + 1] = prof.rate_due_prefix[i] + rate * e.due_time;
+        prof.due_prefix[i + 1] = prof.due_prefix[i] + e.due_time;
+    }
+}
+
+// Number of passengers whose due_time is strictly before `office_arrival`,
+// stepping from the anchor.
+static size_t late_count(const LatenessProfile& prof, int office_arrival) {
+    size_t n = (size_t)prof.anchor;
+    while (n < prof.due.size() && prof.due[n] < office_arrival) n++;
+    while (n > 0 && prof.due[n - 1] >= office_arrival) n--;
+    return n;
+}
+
+void anchor_lateness_profile(LatenessProfile& prof, int office_arrival) {
+    prof.anchor = (int)late_count(prof, office_arrival);
+}
+
+double profile_penalty(const LatenessProfile& prof, int office_arrival) {
+    if (prof.due.empty()) return 0.0;
+    const size_t n = late_count(prof, office_arrival);
+    return (double)office_arrival * prof.rate_prefix[n] - prof.rate_due_prefix[n];
+}
+
+int profile_late_minutes(const LatenessProfile& prof, int office_arrival) {
+    if (prof.due.empty()) return 0;
+    const size_t n = late_count(prof, office_arrival);
+    return (int)((long long)office_arrival * (long long)n - prof.due_prefix[n]);
+}
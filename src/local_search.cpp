@@ -0,0 +1,200 @@
+#include "local_search.h"
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include "alns_operators.h"
+#include "arena.h"
+#include "geo.h"
+#include "config.h"
+#include "lateness.h"
+#include "zobrist.h"
+
+using namespace std;
+
+bool remove_from_trip(vector<Vehicle>& vehicles, int vi, int ri, const string& emp_id,
+                      const EmployeeIndex& idx, SolutionObjective& obj) {
+    Vehicle& v = vehicles[vi];
+    Route& r = v.routes[ri];
+    auto it = find_if(r.stops.begin(), r.stops.end(),
+                      [&](const Stop& s){ return s.is_pickup() && s.emp_id() == emp_id; });
+    if (it == r.stops.end()) return false;
+
+    const RouteObjective before = route_objective(r);
+    const uint64_t key_before = trip_key(r, vi, ri);
+    r.stops.erase(it);
+    // A shorter trip never ends later, so later trips stay feasible as they are.
+    simulate_route(r, v, idx);
+    obj.replace(before, route_objective(r));
+    obj.hash ^= key_before ^ trip_key(r, vi, ri);
+    v.total_cost = vehicle_cost(v);
+    return true;
+}
+
+static int find_trip(const Vehicle& v, const string& emp_id) {
+    for (int ri = 0; ri < (int)v.routes.size(); ri++) {
+        for (const auto& s : v.routes[ri].stops)
+            if (s.is_pickup() && s.emp_id() == emp_id) return ri;
+    }
+    return -1;
+}
+
+int relocate_local_search(vector<Vehicle>& vehicles, const EmployeeIndex& idx,
+                          const ObjectiveWeights& w, SolutionObjective& obj,
+                          mt19937& rng, int max_passes) {
+    // Employee -> vehicle; a relocate changes only the moved employee's entry.
+    unordered_map<string, int> where;
+    vector<string> order;
+    for (int vi = 0; vi < (int)vehicles.size(); vi++) {
+        for (const auto& r : vehicles[vi].routes)
+            for (const auto& s : r.stops)
+                if (s.is_pickup()) { where[s.emp_id()] = vi; order.push_back(s.emp_id()); }
+    }
+
+    int moves = 0;
+    for (int pass = 0; pass < max_passes; pass++) {
+        shuffle(order.begin(), order.end(), rng);
+        int pass_moves = 0;
+
+        for (const auto& id : order) {
+            auto eit = idx.find(id);
+            if (eit == idx.end()) continue;
+            const int vs = where[id];
+            const int rs = find_trip(vehicles[vs], id);
+            if (rs < 0) continue;
+
+            const double before = obj.score(w);
+            const Vehicle saved = vehicles[vs];
+            const SolutionObjective saved_obj = obj;
+
+            remove_from_trip(vehicles, vs, rs, id, idx, obj);
+            InsertionChoice best;
+            if (find_best_insertion(vehicles, *eit->second, idx, w, best) &&
+                obj.score(w) + best.delta < before - 1e-6) {
+                where[id] = best.vi;
+                commit_insertion(vehicles, std::move(best), idx, obj);
+                pass_moves++;
+            } else {
+                vehicles[vs] = saved;
+                obj = saved_obj;
+            }
+        }
+
+        moves += pass_moves;
+        if (pass_moves == 0) break;
+    }
+    return moves;
+}
+
+bool resequence_trip(Route& route, const Vehicle& v, const EmployeeIndex& idx,
+                     const ObjectiveWeights& w) {
+    const int k = (int)route.stops.size() - 2;
+    if (k < 2 || k > RESEQUENCE_MAX_PICKUPS) return false;
+
+    ArenaScope scratch;
+    auto emp = scratch_vec<const Employee*>(k);
+    for (int j = 0; j < k; j++) {
+        auto it = idx.find(route.stops[j + 1].emp_id());
+        if (it == idx.end()) return false;
+        emp[j] = it->second;
+    }
+    const int deadline = route.late.hard_deadline;
+    const Stop& start = route.stops.front();
+    const double per_km = w.cost * v.cost_per_km;
+
+    // Partial score = distance cost + wait - ride weight * sum of pickup departures;
+    // ride itself is k * END - sum(departures), settled once END is known.
+    struct Label { double score; int dep; int prev; int prev_label; };
+    const int full = (1 << k) - 1;
+    // Label lists allocate from the arena too (uses-allocator construction).
+    auto lab = scratch_vec<ScratchVec<Label>>((size_t)(full + 1) * k);
+    auto cell = [&](int mask, int last) -> ScratchVec<Label>& { return lab[(size_t)mask * k + last]; };
+    auto to_office = scratch_vec<int>(k);
+    for (int j = 0; j < k; j++) to_office[j] = travel_minutes(get_dist(emp[j]->pickup, OFFICE), v.speed_kmh);
+
+    // Credit per minute of earlier departure once `mask` is picked up: the wait it
+    // may turn into, plus the ride of each passenger still to board.
+    auto picked = scratch_vec<int>((size_t)full + 1);
+    for (int mask = 1; mask <= full; mask++) picked[mask] = picked[mask >> 1] + (mask & 1);
+    auto offer = [&](int mask, int j, double score, int dep, int prev, int prev_label) {
+        if (dep + to_office[j] > deadline) return;
+        const double credit = w.wait + w.ride * (k - picked[mask]);
+        auto dominates = [&](double s1, int d1, double s2, int d2) {
+            return d1 <= d2 && s1 + credit * (d2 - d1) <= s2;
+        };
+        auto& ls = cell(mask, j);
+        for (const auto& l : ls)
+            if (dominates(l.score, l.dep, score, dep)) return;
+        ls.erase(remove_if(ls.begin(), ls.end(),
+                           [&](const Label& l){ return dominates(score, dep, l.score, l.dep); }), ls.end());
+        ls.push_back({score, dep, prev, prev_label});
+    };
+    auto extend = [&](const Location& from, int from_dep, double score, int mask, int prev, int prev_label) {
+        for (int j = 0; j < k; j++) {
+            if (mask & (1 << j)) continue;
+            const double d = get_dist(from, emp[j]->pickup);
+            const int arrival = from_dep + travel_minutes(d, v.speed_kmh);
+            const int begin = max(arrival, emp[j]->ready_time);
+            const int dep = begin + SERVICE_PICKUP_MIN;
+            offer(mask | (1 << j), j, score + per_km * d + w.wait * (begin - arrival) - w.ride * dep,
+                  dep, prev, prev_label);
+        }
+    };
+
+    extend(start.loc(), start.departure_time, 0.0, 0, -1, -1);
+    for (int mask = 1; mask < full; mask++) {
+        for (int last = 0; last < k; last++) {
+            const auto& ls = cell(mask, last);
+            for (int l = 0; l < (int)ls.size(); l++)
+                extend(emp[last]->pickup, ls[l].dep, ls[l].score, mask, last, l);
+        }
+    }
+
+    int best_last = -1, best_l = -1;
+    double best = numeric_limits<double>::infinity();
+    for (int last = 0; last < k; last++) {
+        const auto& ls = cell(full, last);
+        for (int l = 0; l < (int)ls.size(); l++) {
+            const int end = ls[l].dep + to_office[last];
+            const double total = ls[l].score + per_km * get_dist(emp[last]->pickup, OFFICE)
+                               + w.ride * (double)k * end + w.cost * profile_penalty(route.late, end);
+            if (total < best) { best = total; best_last = last; best_l = l; }
+        }
+    }
+    if (best_last < 0 || best >= route_score(route, w) - 1e-9) return false;
+
+    StopList pickups(k);
+    int mask = full, last = best_last, l = best_l;
+    for (int p = k - 1; p >= 0; p--) {
+        pickups[p] = route.stops[last + 1];
+        const Label& cur = cell(mask, last)[l];
+        mask &= ~(1 << last);
+        last = cur.prev;
+        l = cur.prev_label;
+    }
+    Route cand = route;
+    copy(pickups.begin(), pickups.end(), cand.stops.begin() + 1);
+    if (!simulate_route(cand, v, idx)) return false;
+    route = std::move(cand);
+    return true;
+}
+
+int resequence_trips(vector<Vehicle>& vehicles, const EmployeeIndex& idx,
+                     const ObjectiveWeights& w, SolutionObjective& obj, bool all) {
+    int improved = 0;
+    for (size_t vi = 0; vi < vehicles.size(); vi++) {
+        Vehicle& v = vehicles[vi];
+        for (size_t ri = 0; ri < v.routes.size(); ri++) {
+            Route& r = v.routes[ri];
+            if (!all && !r.removal_gain_stale) continue;
+            Route cand = r;
+            if (!resequence_trip(cand, v, idx, w)) continue;
+            if (!chain_has_slack(v, ri, cand.stops.back().departure_time)) continue;
+            obj.replace(route_objective(r), route_objective(cand));
+            obj.hash ^= trip_key(r, vi, ri) ^ trip_key(cand, vi, ri);
+            r = std::move(cand);
+            improved++;
+        }
+        v.total_cost = vehicle_cost(v);
+    }
+    return improved;
+}
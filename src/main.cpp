@@ -2,12 +2,21 @@
 #include <vector>
 #include <string>
 
+#include "config.h"
 #include "io.h"
 #include "heuristic.h"
 #include "report.h"
 #include "output_json.h"
 #include "file_utils.h"
 #include "alns.h"
+#include "hgs.h"
+#include "trip_pool.h"
+#include "decompose.h"
+#include "warm_start.h"
+#include "online.h"
+#include "route_cache.h"
+#include "task_pool.h"
+#include "insertion_batch.h"
 
 
 
@@ -16,17 +25,15 @@ using namespace std;
 
 #include "alns.h"
 
-// Simple local config 
-static ALNSConfig alns_cfg = {
-    2000,   // iterations
-    4,      // min_remove
-    12,     // max_remove
-    400,    // no_improve_stop
-    500.0,  // T0
-    0.999,  // cooling
-    true,   // use_regret2
-    false   // apply_two_opt_after_repair
-};
+// Simple local config; the driver's ALNS settings are assigned at the top of
+// main(), everything else keeps ALNSConfig's defaults.
+static ALNSConfig alns_cfg;
+
+static HGSConfig hgs_cfg;
+static TripPoolConfig pool_cfg;
+static DecomposeConfig dec_cfg;
+static LayerConfig layer_cfg;
+static OnlineConfig online_cfg;
 
 
 int main(int argc, char** argv) {
@@ -40,23 +47,117 @@ int main(int argc, char** argv) {
     string input_file = "TC02.json";
     string out="output.json";
     bool debug = false;
+    MultiStartConfig ms_cfg;
+    string engine = "alns";
+    string warm_plan;
+    bool iterations_set = false;
+    bool events = false;
+    bool bench = false;
+
+    alns_cfg.iterations = 2000;
+    alns_cfg.min_remove = 4;
+    alns_cfg.max_remove = 12;
+    alns_cfg.no_improve_stop = 400;
+    alns_cfg.T0 = 500.0;
+    alns_cfg.cooling = 0.999;
+    alns_cfg.use_regret2 = true;
+    alns_cfg.apply_two_opt_after_repair = false;
 
     if (argc > 1) input_file = argv[1];
     if (argc > 2) out = argv[2];
-    if (argc > 3 && string(argv[3]) == "--debug") debug = true;
+    // Optional flags after the file names:
+    //   --debug  --starts=N (multi-start construction; default 1 = single pass)
+    //   --sisr (string-removal ruin & recreate instead of the adaptive operator pool)
+    //   --iterations=N  --no-tabu (do not skip repairs that revisit a solution)
+    //   --route-cache=N (memoized trip simulations kept; 0 = off)
+    //   --late-rate=RS (base lateness price per minute; default from the instance,
+    //     see LATENESS_PENALTY_PER_MIN in config.h)
+    //   --bench-insertion (time scalar vs batch insertion pricing on the constructed
+    //     plan, then exit)  --no-simd (scalar batch kernel even where AVX2 exists)
+    //   --threads=N (workers of the task pool that runs the multi-start passes, the
+    //     decomposed part solves and the scans inside one construction or ALNS step;
+    //     0 = hardware concurrency, 1 = serial)  --inner-threads=N (same as --threads)
+    //   --accept=sa|sa-fixed|rrt|threshold|lahc (ALNS acceptance; sa calibrates T0
+    //     to the instance, sa-fixed uses T0/cooling below)
+    //   --engine=alns|hgs|pool  --time-limit=SEC (improvement phase wall time)
+    //   --decompose=SIZE (solve parts of ~SIZE employees concurrently, alns engine)
+    //   --overlap=F (boundary share re-optimized between parts)  --partition=sweep|kmeans
+    //   --layers=MIN (solve office-arrival slots of MIN minutes in order, alns engine)
+    //   --warm-start=PLAN.json (rebuild a previous output's trips, insert the rest;
+    //     ALNS then runs a short budget unless --iterations is given)
+    //   --events (after the first plan, read JSON-line events from stdin and answer
+    //     each with the updated plan; see online.h)  --event-iterations=N
+    for (int i = 3; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--debug") debug = true;
+        else if (arg.rfind("--starts=", 0) == 0) ms_cfg.starts = stoi(arg.substr(9));
+        else if (arg.rfind("--threads=", 0) == 0) task_pool_configure(stoi(arg.substr(10)));
+        else if (arg == "--sisr") alns_cfg.mode = ALNS_SISR;
+        else if (arg == "--no-tabu") alns_cfg.tabu = false;
+        else if (arg.rfind("--accept=", 0) == 0) {
+            const string a = arg.substr(9);
+            alns_cfg.accept.calibrate = a != "sa-fixed";
+            if (a == "sa" || a == "sa-fixed") alns_cfg.accept.kind = ACCEPT_SA;
+            else if (a == "rrt") alns_cfg.accept.kind = ACCEPT_RRT;
+            else if (a == "threshold") alns_cfg.accept.kind = ACCEPT_THRESHOLD;
+            else if (a == "lahc") alns_cfg.accept.kind = ACCEPT_LAHC;
+            else cerr << "Ignoring unknown acceptance: " << a << endl;
+        }
+        else if (arg.rfind("--late-rate=", 0) == 0) LATENESS_PENALTY_PER_MIN = max(0.0, stod(arg.substr(12)));
+        else if (arg.rfind("--route-cache=", 0) == 0) route_cache_configure(stoul(arg.substr(14)));
+        else if (arg == "--bench-insertion") bench = true;
+        else if (arg == "--no-simd") insertion_simd_configure(false);
+        else if (arg.rfind("--inner-threads=", 0) == 0) task_pool_configure(stoi(arg.substr(16)));
+        else if (arg.rfind("--iterations=", 0) == 0) {
+            alns_cfg.iterations = hgs_cfg.iterations = stoi(arg.substr(13));
+            iterations_set = true;
+        }
+        else if (arg.rfind("--engine=", 0) == 0) engine = arg.substr(9);
+        else if (arg.rfind("--time-limit=", 0) == 0) alns_cfg.time_limit_sec = hgs_cfg.time_limit_sec = stod(arg.substr(13));
+        else if (arg.rfind("--decompose=", 0) == 0) dec_cfg.part_size = stoi(arg.substr(12));
+        else if (arg.rfind("--overlap=", 0) == 0) dec_cfg.overlap = stod(arg.substr(10));
+        else if (arg.rfind("--warm-start=", 0) == 0) warm_plan = arg.substr(13);
+        else if (arg == "--events") events = true;
+        else if (arg.rfind("--event-iterations=", 0) == 0) online_cfg.burst_iterations = stoi(arg.substr(19));
+        else if (arg.rfind("--layers=", 0) == 0) layer_cfg.slot_minutes = stoi(arg.substr(9));
+        else if (arg == "--partition=kmeans") dec_cfg.method = PARTITION_KMEANS;
+        else if (arg == "--partition=sweep") dec_cfg.method = PARTITION_SWEEP;
+        else cerr << "Ignoring unknown option: " << arg << endl;
+    }
 
     if (!load_from_json(input_file, employees, vehicles)) {
         cerr << "Failed to load. Exiting." << endl;
         return 1;
     }
 
-    solve_solomon_insertion(employees, vehicles, debug);
+    WarmStartStats warm;
+    const bool warm_started = !warm_plan.empty() && warm_start_from_output(warm_plan, employees, vehicles, warm, debug);
+    if (warm_started && !iterations_set) {
+        alns_cfg.iterations = hgs_cfg.iterations = 300;
+        alns_cfg.no_improve_stop = 150;
+    }
 
-    solve_solomon_insertion(employees, vehicles, debug);
+    const bool decomposed = !warm_started && (dec_cfg.part_size > 0 || layer_cfg.slot_minutes > 0) && engine == "alns";
+    if (warm_started) {
+        // Previous plan rebuilt; the engine below only polishes it.
+    }
+    else if (decomposed && dec_cfg.part_size > 0) solve_decomposed(employees, vehicles, alns_cfg, dec_cfg, debug);
+    else if (decomposed) solve_time_layered(employees, vehicles, alns_cfg, layer_cfg, debug);
+    else if (ms_cfg.starts > 1) solve_multistart(employees, vehicles, ms_cfg, debug);
+    else solve_solomon_insertion(employees, vehicles, debug);
+
+    if (bench) {
+        bench_insertion(employees, vehicles);
+        return 0;
+    }
 
         // OPTIONAL: guard with a flag if you want
         bool use_alns = true;
-        if (use_alns) {
+        if (engine == "hgs") {
+        run_hgs(employees, vehicles, hgs_cfg, debug);
+        } else if (engine == "pool") {
+        solve_trip_pool(employees, vehicles, alns_cfg, pool_cfg, debug);
+        } else if (use_alns && !decomposed) {
         run_alns(employees, vehicles, alns_cfg, debug);
         }
 
@@ -73,6 +174,16 @@ int main(int argc, char** argv) {
         return 1;
     }
    std::cout << "Wrote output to: " << out << "\n";
+
+    if (events) {
+        cout << "\n--- Event stream (stdin) ---" << endl;
+        run_event_stream(employees, vehicles, alns_cfg, online_cfg, cin, cout, debug);
+        if (!write_output_json(out, input_raw, vehicles, employees)) {
+            std::cout << "ERROR: Failed to write output file: " << out << "\n";
+            return 1;
+        }
+        std::cout << "Wrote final plan to: " << out << "\n";
+    }
     
     return 0;
 }
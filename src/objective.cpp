@@ -0,0 +1,74 @@
+#include "objective.h"
+#include "config.h"
+#include "zobrist.h"
+
+ObjectiveWeights objective_weights_from_instance() {
+    ObjectiveWeights w;
+    w.cost = OBJ_COST_WEIGHT;
+    w.ride = OBJ_TIME_WEIGHT * TIME_VALUE_PER_MIN;
+    w.wait = OBJ_TIME_WEIGHT * TIME_VALUE_PER_MIN;
+    return w;
+}
+
+void SolutionObjective::add(const RouteObjective& r) {
+    dist_cost += r.dist_cost;
+    lateness += r.lateness;
+    ride_min += r.ride_min;
+    wait_min += r.wait_min;
+}
+
+void SolutionObjective::remove(const RouteObjective& r) {
+    dist_cost -= r.dist_cost;
+    lateness -= r.lateness;
+    ride_min -= r.ride_min;
+    wait_min -= r.wait_min;
+}
+
+double SolutionObjective::score(const ObjectiveWeights& w) const {
+    return w.cost * (dist_cost + lateness)
+         + w.ride * ride_min
+         + w.wait * wait_min
+         + w.unrouted * (double)unrouted;
+}
+
+void refresh_route_times(Route& route) {
+    route.ride_minutes = 0;
+    route.wait_minutes = 0;
+    if (route.stops.size() < 2) return;
+    const int office_arrival = route.stops.back().arrival_time;
+    for (const auto& s : route.stops) {
+        if (!s.is_pickup()) continue;
+        route.ride_minutes += office_arrival - s.departure_time;
+        route.wait_minutes += s.begin_service - s.arrival_time;
+    }
+}
+
+RouteObjective route_objective(const Route& route) {
+    RouteObjective r;
+    if (route.stops.size() <= 2) return r;   // empty trip: START -> END costs nothing
+    r.dist_cost = route.total_cost;
+    r.lateness = route.lateness_penalty;
+    r.ride_min = route.ride_minutes;
+    r.wait_min = route.wait_minutes;
+    return r;
+}
+
+double route_score(const Route& route, const ObjectiveWeights& w) {
+    const RouteObjective r = route_objective(route);
+    return w.cost * (r.dist_cost + r.lateness) + w.ride * r.ride_min + w.wait * r.wait_min;
+}
+
+double vehicle_cost(const Vehicle& v) {
+    double c = 0.0;
+    for (const auto& r : v.routes) c += route_objective(r).dist_cost;
+    return c;
+}
+
+SolutionObjective evaluate_solution(const std::vector<Employee>& emps, const std::vector<Vehicle>& vehs) {
+    SolutionObjective obj;
+    for (const auto& v : vehs)
+        for (const auto& r : v.routes) obj.add(route_objective(r));
+    for (const auto& e : emps) if (!e.is_routed) obj.unrouted++;
+    obj.hash = solution_hash(vehs);
+    return obj;
+}
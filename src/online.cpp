@@ -0,0 +1,341 @@
+#include "online.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include "alns_operators.h"
+#include "compat.h"
+#include "config.h"
+#include "heuristic.h"
+#include "io.h"
+#include "json_serialize.h"
+#include "mini_json.h"
+#include "objective.h"
+#include "route_eval.h"
+#include "time_utils.h"
+
+using namespace std;
+using Json = mini_json::Value;
+
+// ------------------------------------------------------------
+// Plan state
+// ------------------------------------------------------------
+struct OnlineState {
+    vector<Employee> roster;       // everyone ever known; position == Employee::index
+    vector<char> cancelled;        // by Employee::index
+    vector<Vehicle> fleet;         // each vehicle: frozen trips first, then open ones
+    vector<size_t> frozen;         // leading trips of each vehicle already on the road
+    vector<int> ready_at;          // earliest departure of each vehicle's next open trip
+    vector<char> unavailable;
+    EmployeeIndex idx;             // over the roster; rebuilt whenever it grows
+    int now = 0;
+};
+
+// The open part of the plan as a standalone instance for insertion and ALNS.
+struct OpenPart {
+    vector<Employee> emps;
+    vector<Vehicle> vehs;
+    vector<int> veh_ids;           // positions in the fleet
+};
+
+static vector<char> frozen_passengers(const OnlineState& st) {
+    vector<char> out(st.roster.size(), 0);
+    for (size_t vi = 0; vi < st.fleet.size(); vi++)
+        for (size_t r = 0; r < st.frozen[vi]; r++)
+            for (const auto& s : st.fleet[vi].routes[r].stops)
+                if (s.is_pickup()) out[s.node] = 1;
+    return out;
+}
+
+// Open trips of every usable vehicle, leaving no earlier than the vehicle is
+// ready; a chain that no longer fits after a delay is dropped (its passengers
+// come back unrouted and are repaired).
+static OpenPart open_part(const OnlineState& st) {
+    OpenPart part;
+    const vector<char> frozen = frozen_passengers(st);
+    vector<char> on_open(st.roster.size(), 0);
+
+    for (size_t vi = 0; vi < st.fleet.size(); vi++) {
+        if (st.unavailable[vi]) continue;
+        const Vehicle& v = st.fleet[vi];
+        Vehicle open = vehicle_before_trip(v, st.frozen[vi]);
+        open.available_time = max({open.available_time, st.now, st.ready_at[vi]});
+        for (size_t r = st.frozen[vi]; r < v.routes.size(); r++)
+            if (!is_empty_trip(v.routes[r])) open.routes.push_back(v.routes[r]);
+
+        if (!open.routes.empty() && open.routes[0].stops.front().departure_time < open.available_time) {
+            Stop& start = open.routes[0].stops.front();
+            start.arrival_time = start.begin_service = start.departure_time = open.available_time;
+            if (!simulate_route(open.routes[0], open, st.idx) || !rechain_trips(open, 0, st.idx))
+                open.routes.clear();
+        }
+        if (open.routes.empty()) {
+            Route r = make_empty_trip(open);
+            simulate_route(r, open, st.idx);
+            open.routes.push_back(std::move(r));
+        }
+        for (const auto& r : open.routes)
+            for (const auto& s : r.stops)
+                if (s.is_pickup()) on_open[s.node] = 1;
+        part.vehs.push_back(std::move(open));
+        part.veh_ids.push_back((int)vi);
+    }
+
+    for (const auto& e : st.roster) {
+        if (st.cancelled[e.index] || frozen[e.index]) continue;
+        part.emps.push_back(e);
+        part.emps.back().is_routed = on_open[e.index] != 0;
+    }
+    return part;
+}
+
+// Cheapest insertion of the open part's unrouted employees, tightest first.
+static void repair(OpenPart& part) {
+    const EmployeeIndex idx = build_employee_index(part.emps);
+    const ObjectiveWeights w = objective_weights_from_instance();
+    SolutionState state = build_solution_state(part.emps, part.vehs);
+    SolutionObjective obj = evaluate_solution(part.emps, part.vehs);
+    for (int i : get_sorted_indices_by_tightness(part.emps)) {
+        const Employee& e = part.emps[i];
+        if (state.routed[e.index]) continue;
+        if (try_insert_anywhere(state, part.vehs, e, idx, w, obj)) g_unrouted_reason.erase(e.id);
+        else g_unrouted_reason[e.id] = "No feasible insertion after the last event";
+    }
+    store_routed_flags(state, part.emps);
+}
+
+// Writes the open part back behind each vehicle's frozen trips.
+static void commit(OnlineState& st, const OpenPart& part) {
+    for (size_t j = 0; j < part.veh_ids.size(); j++) {
+        Vehicle& v = st.fleet[part.veh_ids[j]];
+        v.routes.resize(st.frozen[part.veh_ids[j]]);
+        for (const auto& r : part.vehs[j].routes)
+            if (!is_empty_trip(r)) v.routes.push_back(r);
+        if (v.routes.empty()) v.routes.push_back(part.vehs[j].routes.front());   // idle: keep its start
+        v.total_cost = vehicle_cost(v);
+    }
+    for (const auto& e : part.emps) st.roster[e.index].is_routed = e.is_routed;
+}
+
+// Node table and compatibility bits after the roster changed. Pickup nodes
+// keep their index; the office and depot nodes behind them move up by the
+// number of new employees, so every stored node is remapped.
+static void rebuild_tables(OnlineState& st, int old_n) {
+    const int shift = (int)st.roster.size() - old_n;
+    auto remap = [&](int node) { return node >= old_n ? node + shift : node; };
+    vector<int> current(st.fleet.size());
+    for (size_t vi = 0; vi < st.fleet.size(); vi++) current[vi] = st.fleet[vi].current_node;
+
+    build_node_table(st.roster, st.fleet);
+    build_compat(st.roster, st.fleet);
+    st.idx = build_employee_index(st.roster);
+    for (size_t vi = 0; vi < st.fleet.size(); vi++) {
+        Vehicle& v = st.fleet[vi];
+        v.current_node = remap(current[vi]);
+        for (auto& r : v.routes) {
+            for (auto& s : r.stops) s.node = remap(s.node);
+            finalize_route(r, v, st.idx);     // compat mask width follows the roster
+        }
+    }
+}
+
+// ------------------------------------------------------------
+// Events
+// ------------------------------------------------------------
+static int vehicle_position(const OnlineState& st, const string& id) {
+    for (size_t vi = 0; vi < st.fleet.size(); vi++)
+        if (st.fleet[vi].id == id) return (int)vi;
+    throw runtime_error("unknown vehicle " + id);
+}
+
+static void on_add(OnlineState& st, const Json& ev) {
+    const string id = ev["employee_id"].as_string();
+    if (id.empty() || !ev["employee"].is_object()) throw runtime_error("add needs employee_id and employee");
+    Employee e = parse_employee(id, ev["employee"]);
+
+    const int old_n = (int)st.roster.size();
+    auto it = st.idx.find(id);
+    if (it != st.idx.end()) {
+        const int i = it->second->index;
+        if (!st.cancelled[i]) throw runtime_error("employee " + id + " is already in the plan");
+        e.index = i;                  // re-booked after a cancellation: reuse the slot
+        st.roster[i] = e;
+        st.cancelled[i] = 0;
+    } else {
+        e.index = old_n;
+        st.roster.push_back(e);
+        st.cancelled.push_back(0);
+    }
+    rebuild_tables(st, old_n);
+}
+
+static void on_cancel(OnlineState& st, const Json& ev) {
+    const string id = ev["employee_id"].as_string();
+    auto it = st.idx.find(id);
+    if (it == st.idx.end() || st.cancelled[it->second->index]) throw runtime_error("unknown employee " + id);
+    const int i = it->second->index;
+    if (frozen_passengers(st)[i]) throw runtime_error("employee " + id + " is on a trip that has already left");
+
+    st.cancelled[i] = 1;
+    st.roster[i].is_routed = false;
+    g_unrouted_reason.erase(id);
+    for (auto& v : st.fleet) {
+        for (size_t r = 0; r < v.routes.size(); r++) {
+            auto& stops = v.routes[r].stops;
+            auto at = find_if(stops.begin(), stops.end(), [&](const Stop& s) { return s.is_pickup() && s.node == i; });
+            if (at == stops.end()) continue;
+            stops.erase(at);
+            simulate_route(v.routes[r], v, st.idx);
+            rechain_trips(v, r, st.idx);
+            v.total_cost = vehicle_cost(v);
+            return;
+        }
+    }
+}
+
+static void on_delay(OnlineState& st, const Json& ev) {
+    const int vi = vehicle_position(st, ev["vehicle_id"].as_string());
+    const int minutes = ev["minutes"].as_int(0);
+    if (minutes < 0) throw runtime_error("delay minutes must be >= 0");
+    const Vehicle& v = st.fleet[vi];
+    int next = vehicle_before_trip(v, st.frozen[vi]).available_time;
+    for (size_t r = st.frozen[vi]; r < v.routes.size(); r++)
+        if (!is_empty_trip(v.routes[r])) { next = max(next, v.routes[r].stops.front().departure_time); break; }
+    st.ready_at[vi] = max({st.ready_at[vi], st.now, next}) + minutes;
+}
+
+static void on_unavailable(OnlineState& st, const Json& ev) {
+    const int vi = vehicle_position(st, ev["vehicle_id"].as_string());
+    Vehicle& v = st.fleet[vi];
+    st.unavailable[vi] = 1;
+    for (size_t r = st.frozen[vi]; r < v.routes.size(); r++)
+        for (const auto& s : v.routes[r].stops)
+            if (s.is_pickup()) st.roster[s.node].is_routed = false;
+    v.routes.resize(st.frozen[vi]);
+    v.total_cost = vehicle_cost(v);
+}
+
+// Trips that have left by `time` become frozen.
+static void on_advance(OnlineState& st, const Json& ev) {
+    const Json& t = ev["time"];
+    const int time = t.is_number() ? t.as_int() : parse_time(t.as_string());
+    if (time < st.now) throw runtime_error("time cannot go backwards");
+    st.now = time;
+    for (size_t vi = 0; vi < st.fleet.size(); vi++) {
+        const auto& routes = st.fleet[vi].routes;
+        for (size_t r = st.frozen[vi]; r < routes.size(); r++)
+            if (!is_empty_trip(routes[r]) && routes[r].stops.front().departure_time <= st.now) st.frozen[vi] = r + 1;
+    }
+}
+
+// ------------------------------------------------------------
+// Answers
+// ------------------------------------------------------------
+static Json jvalue(Json::Type type) { Json v; v.type = type; return v; }
+static Json jstring(const string& s) { Json v = jvalue(Json::Type::String); v.str = s; return v; }
+static Json jnumber(double d) { Json v = jvalue(Json::Type::Number); v.num = d; return v; }
+static Json jbool(bool b) { Json v = jvalue(Json::Type::Bool); v.b = b; return v; }
+
+static vector<Employee> active_roster(const OnlineState& st) {
+    vector<Employee> out;
+    for (const auto& e : st.roster) if (!st.cancelled[e.index]) out.push_back(e);
+    return out;
+}
+
+static Json plan_answer(const OnlineState& st, int seq, const string& type, const string& error, double ms) {
+    const vector<Employee> active = active_roster(st);
+    Json a = jvalue(Json::Type::Object);
+    a.obj["event"] = jnumber(seq);
+    a.obj["type"] = jstring(type);
+    a.obj["ok"] = jbool(error.empty());
+    if (!error.empty()) a.obj["error"] = jstring(error);
+    a.obj["ms"] = jnumber(ms);
+    a.obj["now"] = jstring(format_time(st.now));
+    a.obj["objective_score"] = jnumber(evaluate_solution(active, st.fleet).score(objective_weights_from_instance()));
+
+    Json unrouted = jvalue(Json::Type::Array);
+    int routed = 0;
+    for (const auto& e : active) {
+        if (e.is_routed) routed++;
+        else unrouted.arr.push_back(jstring(e.id));
+    }
+    a.obj["employees_routed"] = jnumber(routed);
+    a.obj["unrouted"] = std::move(unrouted);
+
+    Json vehs = jvalue(Json::Type::Array);
+    for (size_t vi = 0; vi < st.fleet.size(); vi++) {
+        const Vehicle& v = st.fleet[vi];
+        Json jv = jvalue(Json::Type::Object);
+        jv.obj["vehicle_id"] = jstring(v.id);
+        jv.obj["available"] = jbool(!st.unavailable[vi]);
+        Json trips = jvalue(Json::Type::Array);
+        for (size_t r = 0; r < v.routes.size(); r++) {
+            if (is_empty_trip(v.routes[r])) continue;
+            Json jt = jvalue(Json::Type::Object);
+            jt.obj["frozen"] = jbool(r < st.frozen[vi]);
+            jt.obj["start_time"] = jstring(format_time(v.routes[r].stops.front().departure_time));
+            jt.obj["end_time"] = jstring(format_time(v.routes[r].stops.back().arrival_time));
+            Json route = jvalue(Json::Type::Array);
+            for (const auto& s : v.routes[r].stops) route.arr.push_back(jstring(s.emp_id()));
+            jt.obj["route"] = std::move(route);
+            trips.arr.push_back(std::move(jt));
+        }
+        jv.obj["trips"] = std::move(trips);
+        vehs.arr.push_back(std::move(jv));
+    }
+    a.obj["vehicles"] = std::move(vehs);
+    return a;
+}
+
+void run_event_stream(vector<Employee>& employees, vector<Vehicle>& vehicles,
+                      const ALNSConfig& alns_cfg, const OnlineConfig& cfg,
+                      istream& in, ostream& out, bool debug) {
+    OnlineState st;
+    st.roster = employees;
+    st.cancelled.assign(employees.size(), 0);
+    st.fleet = vehicles;
+    st.frozen.assign(vehicles.size(), 0);
+    st.ready_at.assign(vehicles.size(), 0);
+    st.unavailable.assign(vehicles.size(), 0);
+    st.idx = build_employee_index(st.roster);
+
+    ALNSConfig burst = alns_cfg;
+    burst.iterations = cfg.burst_iterations;
+    burst.no_improve_stop = cfg.burst_no_improve;
+    burst.time_limit_sec = 0.0;
+
+    string line;
+    int seq = 0;
+    while (getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == string::npos) continue;
+        const auto t0 = chrono::steady_clock::now();
+        string type, error;
+        try {
+            const Json ev = mini_json::parse(line);
+            type = ev["type"].as_string();
+            if (type == "quit") break;
+            if (type == "add") on_add(st, ev);
+            else if (type == "cancel") on_cancel(st, ev);
+            else if (type == "delay") on_delay(st, ev);
+            else if (type == "unavailable") on_unavailable(st, ev);
+            else if (type == "advance") on_advance(st, ev);
+            else throw runtime_error("unknown event type '" + type + "'");
+
+            OpenPart part = open_part(st);
+            repair(part);
+            int placed = 0;
+            for (const auto& e : part.emps) placed += e.is_routed;
+            if (placed >= 2) run_alns(part.emps, part.vehs, burst, false);
+            commit(st, part);
+        } catch (const exception& ex) {
+            error = ex.what();
+        }
+        const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        if (debug) cout << "[ONLINE] event " << seq << " (" << type << ") " << ms << " ms" << endl;
+        write_json_line(out, plan_answer(st, seq++, type, error, ms));
+        out << endl;
+    }
+
+    employees = active_roster(st);
+    vehicles = st.fleet;
+}
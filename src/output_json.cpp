@@ -3,10 +3,15 @@
 #include "geo.h"
 #include "time_utils.h"
 #include "json_serialize.h"
+#include "lateness.h"
+#include "objective.h"
+#include "route_cache.h"
 
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
+#include <map>
 #include <sstream>
 
 // Escape strings for JSON safely (quotes, backslashes, newlines, etc.)
@@ -43,18 +48,25 @@ static double total_cost_all(const std::vector<Vehicle>& vehs) {
     return c;
 }
 
+static double total_lateness_all(const std::vector<Vehicle>& vehs) {
+    double p = 0.0;
+    for (const auto& v : vehs)
+        for (const auto& r : v.routes) p += r.lateness_penalty;
+    return p;
+}
+
 // Collect passengers from a route in the stop order
 static std::vector<std::string> passengers_in_route(const Route& r) {
     std::vector<std::string> ids;
     for (const auto& s : r.stops) {
-        if (s.is_pickup) ids.push_back(s.emp_id);
+        if (s.is_pickup()) ids.push_back(s.emp_id());
     }
     return ids;
 }
 
 static const Stop* find_pickup_stop(const Route& r, const std::string& emp_id) {
     for (const auto& s : r.stops) {
-        if (s.is_pickup && s.emp_id == emp_id) return &s;
+        if (s.is_pickup() && s.emp_id() == emp_id) return &s;
     }
     return nullptr;
 }
@@ -82,6 +94,27 @@ bool write_output_json(
     double net_savings = baseline_total - optimized_total;
     double savings_pct = (baseline_total > 1e-9) ? (net_savings / baseline_total) * 100.0 : 0.0;
 
+    const double lateness_total = total_lateness_all(vehs);
+    const SolutionObjective obj = evaluate_solution(emps, vehs);
+    const ObjectiveWeights weights = objective_weights_from_instance();
+    double baseline_time_total = 0.0;
+    for (const auto& e : emps) baseline_time_total += e.baseline_time;
+    std::map<std::string, const Employee*> emp_by_id;
+    for (const auto& e : emps) emp_by_id[e.id] = &e;
+
+    int late_employees = 0;
+    for (const auto& v : vehs) {
+        for (const auto& r : v.routes) {
+            if (r.stops.empty()) continue;
+            const int drop = r.stops.back().arrival_time;
+            for (const auto& s : r.stops) {
+                if (!s.is_pickup()) continue;
+                auto it = emp_by_id.find(s.emp_id());
+                if (it != emp_by_id.end() && drop > it->second->due_time) late_employees++;
+            }
+        }
+    }
+
     out << std::fixed << std::setprecision(6);
     out << "{\n";
 
@@ -95,7 +128,22 @@ bool write_output_json(
     out << "    \"total_baseline_cost\": " << baseline_total << ",\n";
     out << "    \"total_optimized_cost\": " << optimized_total << ",\n";
     out << "    \"net_savings\": " << net_savings << ",\n";
-    out << "    \"savings_percentage\": " << savings_pct << "\n";
+    out << "    \"savings_percentage\": " << savings_pct << ",\n";
+    out << "    \"late_employees\": " << late_employees << ",\n";
+    out << "    \"total_lateness_penalty\": " << lateness_total << ",\n";
+    out << "    \"total_ride_time_min\": " << obj.ride_min << ",\n";
+    out << "    \"total_wait_time_min\": " << obj.wait_min << ",\n";
+    out << "    \"total_baseline_time_min\": " << baseline_time_total << ",\n";
+    out << "    \"objective_cost_weight\": " << weights.cost << ",\n";
+    out << "    \"objective_score\": " << obj.score(weights) << ",\n";
+    const RouteCacheStats rc = route_cache_stats();
+    out << "    \"route_cache\": {"
+        << "\"lookups\": " << rc.lookups << ", "
+        << "\"hits\": " << rc.hits << ", "
+        << "\"hit_rate\": " << (rc.lookups ? (double)rc.hits / rc.lookups : 0.0) << ", "
+        << "\"entries\": " << rc.entries << ", "
+        << "\"capacity\": " << rc.capacity << ", "
+        << "\"bytes\": " << rc.bytes << "}\n";
     out << "  },\n";
 
     // unrouted details (from global map)
@@ -145,12 +193,14 @@ bool write_output_json(
             out << "          \"end_time\": \"" << format_time(end_min) << "\",\n";
             out << "          \"trip_distance_km\": " << r.total_distance << ",\n";
             out << "          \"trip_cost\": " << r.total_cost << ",\n";
+            out << "          \"late_minutes\": " << r.late_minutes << ",\n";
+            out << "          \"lateness_penalty\": " << r.lateness_penalty << ",\n";
 
             // route node list
             out << "          \"route\": [";
             for (size_t si = 0; si < r.stops.size(); si++) {
                 if (si) out << ", ";
-                out << "\"" << json_escape(r.stops[si].emp_id) << "\"";
+                out << "\"" << json_escape(r.stops[si].emp_id()) << "\"";
             }
             out << "],\n";
 
@@ -162,12 +212,17 @@ bool write_output_json(
             for (size_t pi = 0; pi < p.size(); pi++) {
                 const std::string& eid = p[pi];
                  const Stop* ps = find_pickup_stop(r, eid);
+                 auto eit = emp_by_id.find(eid);
+                 const int delay = (eit == emp_by_id.end()) ? 0 : std::max(0, drop_min - eit->second->due_time);
+                 const int prio = (eit == emp_by_id.end()) ? 0 : priority_class(*eit->second);
 
               if (pi) out << ",\n";
     out << "            {"
         << "\"employee_id\": \"" << json_escape(eid) << "\", "
         << "\"pickup_time\": \"" << (ps ? format_time(ps->departure_time) : std::string("00:00")) << "\", "
-        << "\"drop_time\": \"" << format_time(drop_min) << "\""
+        << "\"drop_time\": \"" << format_time(drop_min) << "\", "
+        << "\"priority\": " << prio << ", "
+        << "\"delay_min\": " << delay
         << "}";
 }
             out << "]\n";
@@ -1,6 +1,10 @@
 #include "report.h"
 #include "time_utils.h"
 #include "config.h"
+#include "lateness.h"
+#include "objective.h"
+#include "route_cache.h"
+#include "route_eval.h"
 #include <iostream>
 #include <iomanip>
 #include <vector>
@@ -16,44 +20,49 @@ void display_report(const vector<Vehicle>& vehs, const vector<Employee>& emps) {
     double grand_total = 0;
     int total_routed = 0;
     int total_trips = 0;
+    double grand_lateness = 0;
+    const EmployeeIndex idx = build_employee_index(emps);
 
     for (const auto& v : vehs) {
-        if (v.routes.empty() || v.routes[0].stops.size() <= 1) continue;
+        bool used = false;
+        for (const auto& r : v.routes) used = used || r.stops.size() > 2;
+        if (!used) continue;
 
         cout << "\n" << v.id << " (" << (v.category == PREMIUM ? "Premium" : "Normal") << "):" << endl;
 
         for (size_t r = 0; r < v.routes.size(); r++) {
             const Route& route = v.routes[r];
-            if (route.stops.size() <= 1) continue;
+            if (route.stops.size() <= 2) continue;   // empty START -> END trip
             
             total_trips++;
             
-            // Extract unique employees
-            vector<string> employees_in_route;
+            const size_t passengers = route.stops.size() - 2;
+            cout << "  Trip #" << (r + 1) << " (" << passengers << " passenger"
+                 << (passengers > 1 ? "s" : "") << "):" << endl;
+
+            // All passengers share the same dropoff time at END (office).
+            const string dr_time = format_time(route.stops.back().arrival_time);
             for (const auto& stop : route.stops) {
-                if (stop.emp_id != "START" && stop.is_pickup) {
-                    employees_in_route.push_back(stop.emp_id);
-                }
-            }
-            
-            cout << "  Trip #" << (r + 1) << " (" << employees_in_route.size() << " passenger"
-                 << (employees_in_route.size() > 1 ? "s" : "") << "):" << endl;
-            
-            for (const string& eid : employees_in_route) {
-                // Find pickup + dropoff times
-                string pu_time = "N/A";
-                // All passengers share the same dropoff time at END (office).
-                string dr_time = format_time(route.stops.back().arrival_time);
-                for (const auto& stop : route.stops) {
-                    if (stop.emp_id != eid) continue;
-                    if (stop.is_pickup) pu_time = format_time(stop.begin_service); // respect earliest_pickup
+                if (!stop.is_pickup()) continue;
+                const string& eid = stop.emp_id();
+                // Pickup at begin_service, which respects earliest_pickup.
+                cout << "    - " << eid << " (Pickup " << format_time(stop.begin_service)
+                     << ", Dropoff " << dr_time << ")";
+                auto it = idx.find(eid);
+                if (it != idx.end()) {
+                    const Employee& e = *it->second;
+                    int late = route.stops.back().arrival_time - e.due_time;
+                    if (late > 0) cout << " [LATE " << late << " min, P" << priority_class(e) << "]";
                 }
-               
-                cout << "    - " << eid << " (Pickup " << pu_time << ", Dropoff " << dr_time << ")" << endl;
+                cout << endl;
                 total_routed++;
             }
             
             cout << "    Cost: Rs." << fixed << setprecision(2) << route.total_cost << endl;
+            if (route.lateness_penalty > 0.0) {
+                cout << "    Lateness Penalty: Rs." << route.lateness_penalty << endl;
+            }
+            grand_lateness += route.lateness_penalty;
         }
 
         cout << "  Vehicle Total: Rs." << v.total_cost << endl;
@@ -84,6 +93,7 @@ void display_report(const vector<Vehicle>& vehs, const vector<Employee>& emps) {
     cout << "  Employees Routed: " << total_routed << "/" << emps.size() << endl;
     cout << "  Total Trips:      " << total_trips << endl;
     cout << "  Optimized Cost:   Rs." << grand_total << endl;
+    cout << "  Lateness Penalty: Rs." << grand_lateness << endl;
     cout << "  Baseline Cost:    Rs." << baseline << endl;
     double savings = (baseline - grand_total);
     cout << "  Savings:          Rs." << savings;
@@ -91,6 +101,19 @@ void display_report(const vector<Vehicle>& vehs, const vector<Employee>& emps) {
         cout << " (" << (savings / baseline * 100) << "%)";
     }
     cout << endl;
+
+    const SolutionObjective obj = evaluate_solution(emps, vehs);
+    double baseline_time = 0;
+    for (const auto& e : emps) if (e.is_routed) baseline_time += e.baseline_time;
+    cout << "  Ride Time:        " << obj.ride_min << " min (baseline " << baseline_time << " min)" << endl;
+    cout << "  Wait Time:        " << obj.wait_min << " min" << endl;
+    cout << "  Objective Score:  " << obj.score(objective_weights_from_instance()) << endl;
+    const RouteCacheStats rc = route_cache_stats();
+    if (rc.capacity > 0) {
+        cout << "  Route Cache:      " << (rc.lookups ? 100.0 * rc.hits / rc.lookups : 0.0) << "% hits ("
+             << rc.hits << "/" << rc.lookups << "), " << rc.entries << "/" << rc.capacity << " entries, "
+             << rc.evictions << " evictions, " << rc.bytes / 1024 << " KiB" << endl;
+    }
     cout << "=======================================================" << endl;
 }
 
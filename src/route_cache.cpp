@@ -0,0 +1,226 @@
+#include "route_cache.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "zobrist.h"
+
+namespace {
+
+constexpr size_t SHARDS = 16;
+
+struct Entry {
+    double speed_kmh = 0.0;
+    bool feasible = false;
+    Route route;
+};
+
+// Keys, chain links and CLOCK bits live in their own small arrays, apart from
+// the trips, so a lookup that misses never touches an entry.
+struct Shard {
+    std::mutex m;
+    std::vector<Entry> entries;    // allocated on first put
+    std::vector<uint64_t> keys;    // per entry
+    std::vector<int> chain;        // per entry: next entry in the same bucket
+    std::vector<uint8_t> referenced;   // per entry: CLOCK bit, set on every hit
+    std::vector<int> buckets;
+    std::vector<uint64_t> seen;    // doorkeeper bitmap of keys that missed once
+    size_t seen_set = 0;
+    int hand = 0;                  // CLOCK hand
+    int used = 0;
+    uint64_t lookups = 0, hits = 0, evictions = 0;
+
+    int& bucket(uint64_t key) { return buckets[(key >> 4) & (buckets.size() - 1)]; }
+    // True if `key` already missed once since the bitmap was last cleared; the
+    // bitmap is cleared when half full so old one-off keys age out.
+    bool admit(uint64_t key) {
+        const size_t bit = (key >> 24) & (seen.size() * 64 - 1);
+        uint64_t& word = seen[bit >> 6];
+        const uint64_t mask = 1ull << (bit & 63);
+        if (word & mask) return true;
+        word |= mask;
+        if (++seen_set * 2 >= seen.size() * 64) {
+            std::fill(seen.begin(), seen.end(), 0);
+            seen_set = 0;
+        }
+        return false;
+    }
+    // Next entry without its CLOCK bit, clearing the bits it passes.
+    int victim() {
+        for (;;) {
+            const int i = hand;
+            hand = hand + 1 == (int)entries.size() ? 0 : hand + 1;
+            if (!referenced[i]) return i;
+            referenced[i] = 0;
+        }
+    }
+    void unchain(int i) {
+        int* p = &bucket(keys[i]);
+        while (*p != i) p = &chain[*p];
+        *p = chain[i];
+        chain[i] = -1;
+    }
+};
+
+Shard g_shards[SHARDS];
+size_t g_per_shard = 1024;         // 16K entries by default
+
+Shard& shard_of(uint64_t key) { return g_shards[key & (SHARDS - 1)]; }
+
+bool same_trip(const Entry& e, double speed_kmh, const TripSequence& seq) {
+    if (e.speed_kmh != speed_kmh) return false;
+    const StopList& a = e.route.stops;
+    const StopList& b = seq.base;
+    const size_t extra = seq.pos > 0 ? 1 : 0;
+    if (a.size() != b.size() + extra || a[0].departure_time != b[0].departure_time) return false;
+    if (!extra) {
+        for (size_t i = 0; i < a.size(); i++)
+            if (a[i].node != b[i].node) return false;
+        return true;
+    }
+    const size_t pos = (size_t)seq.pos;
+    for (size_t i = 0; i < pos; i++)
+        if (a[i].node != b[i].node) return false;
+    if (a[pos].node != seq.node) return false;
+    for (size_t i = pos; i < b.size(); i++)
+        if (a[i + 1].node != b[i].node) return false;
+    return true;
+}
+
+int find(Shard& s, uint64_t key, double speed_kmh, const TripSequence& seq) {
+    if (s.entries.empty()) return -1;
+    for (int i = s.bucket(key); i >= 0; i = s.chain[i])
+        if (s.keys[i] == key && same_trip(s.entries[i], speed_kmh, seq)) return i;
+    return -1;
+}
+
+// Looks `seq` up and marks it referenced; -1 on a miss. Caller holds s.m.
+int lookup(Shard& s, uint64_t key, double speed_kmh, const TripSequence& seq) {
+    s.lookups++;
+    const int i = find(s, key, speed_kmh, seq);
+    if (i < 0) return -1;
+    s.hits++;
+    s.referenced[i] = 1;
+    return i;
+}
+
+}  // namespace
+
+static inline uint64_t mix_bits(double x) {
+    uint64_t b;
+    std::memcpy(&b, &x, sizeof(b));
+    return leg_key((int)(b >> 32), (int)b);
+}
+
+void route_cache_configure(size_t capacity) {
+    for (auto& s : g_shards) {
+        std::lock_guard<std::mutex> lock(s.m);
+        s.entries.clear();
+        s.entries.shrink_to_fit();
+        s.keys.clear();
+        s.chain.clear();
+        s.referenced.clear();
+        s.buckets.clear();
+        s.seen.clear();
+        s.seen_set = 0;
+        s.hand = 0;
+        s.used = 0;
+    }
+    g_per_shard = (capacity + SHARDS - 1) / SHARDS;
+}
+
+void route_cache_clear() {
+    for (auto& s : g_shards) {
+        std::lock_guard<std::mutex> lock(s.m);
+        for (auto& b : s.buckets) b = -1;
+        std::fill(s.seen.begin(), s.seen.end(), 0);
+        s.seen_set = 0;
+        s.hand = 0;
+        s.used = 0;
+    }
+}
+
+RouteCacheStats route_cache_stats() {
+    RouteCacheStats st;
+    st.capacity = g_per_shard * SHARDS;
+    for (auto& s : g_shards) {
+        std::lock_guard<std::mutex> lock(s.m);
+        st.lookups += s.lookups;
+        st.hits += s.hits;
+        st.evictions += s.evictions;
+        st.entries += s.used;
+        st.bytes += s.entries.capacity() * (sizeof(Entry) + sizeof(uint64_t) + sizeof(int) + 1) +
+                    s.buckets.capacity() * sizeof(int) + s.seen.capacity() * sizeof(uint64_t);
+    }
+    return st;
+}
+
+uint64_t route_cache_key(uint64_t stops_hash, int start, double speed_kmh) {
+    return stops_hash ^ leg_key(-1, start) ^ mix_bits(speed_kmh);
+}
+
+uint64_t route_cache_key(const Route& route, const Vehicle& v) {
+    const int start = route.stops.empty() ? 0 : route.stops[0].departure_time;
+    return route_cache_key(route_hash(route.stops), start, v.speed_kmh);
+}
+
+bool route_cache_get(uint64_t key, const Vehicle& v, const TripSequence& seq, Route& route, bool& feasible) {
+    if (g_per_shard == 0) return false;
+    Shard& s = shard_of(key);
+    std::lock_guard<std::mutex> lock(s.m);
+    const int i = lookup(s, key, v.speed_kmh, seq);
+    if (i < 0) return false;
+    const int max_capacity = route.max_capacity;
+    route = s.entries[i].route;
+    route.max_capacity = max_capacity;
+    route.total_cost = route.total_distance * v.cost_per_km;
+    route.removal_gain_stale = true;
+    feasible = s.entries[i].feasible;
+    return true;
+}
+
+bool route_cache_get_stops(uint64_t key, double speed_kmh, const TripSequence& seq, StopList& stops) {
+    if (g_per_shard == 0) return false;
+    Shard& s = shard_of(key);
+    std::lock_guard<std::mutex> lock(s.m);
+    const int i = lookup(s, key, speed_kmh, seq);
+    if (i < 0) return false;
+    stops = s.entries[i].route.stops;
+    return true;
+}
+
+void route_cache_put(uint64_t key, const Vehicle& v, const Route& route, bool feasible) {
+    if (g_per_shard == 0) return;
+    Shard& s = shard_of(key);
+    std::lock_guard<std::mutex> lock(s.m);
+    if (s.entries.empty()) {
+        s.entries.resize(g_per_shard);
+        s.keys.assign(g_per_shard, 0);
+        s.chain.assign(g_per_shard, -1);
+        s.referenced.assign(g_per_shard, 0);
+        size_t nb = 1;
+        while (nb < 2 * g_per_shard) nb <<= 1;
+        s.buckets.assign(nb, -1);
+        s.seen.assign(std::max<size_t>(1, nb / 32), 0);   // at least 4 bits per entry
+    }
+    if (!s.admit(key)) return;                    // first miss: most candidates never come back
+    if (find(s, key, v.speed_kmh, {route.stops}) >= 0) return;     // another thread got there first
+
+    int i;
+    if (s.used < (int)s.entries.size()) {
+        i = s.used++;
+    } else {
+        i = s.victim();
+        s.unchain(i);
+        s.evictions++;
+    }
+    Entry& e = s.entries[i];
+    e.speed_kmh = v.speed_kmh;
+    e.feasible = feasible;
+    e.route = route;
+    s.keys[i] = key;
+    s.referenced[i] = 0;
+    int& b = s.bucket(key);
+    s.chain[i] = b;
+    b = i;
+}
@@ -0,0 +1,335 @@
+#include "route_eval.h"
+#include "route_cache.h"
+#include "zobrist.h"
+#include "geo.h"
+#include "config.h"
+#include "lateness.h"
+#include "objective.h"
+#include "compat.h"
+#include <algorithm>
+
+using namespace std;
+
+NodeTable g_nodes;
+
+void build_node_table(const vector<Employee>& emps, vector<Vehicle>& vehs) {
+    NodeTable t;
+    t.n_pickups = (int)emps.size();
+    t.ids.resize(emps.size());
+    t.locs.resize(emps.size());
+    t.ready.resize(emps.size());
+    for (size_t i = 0; i < emps.size(); i++) {
+        t.ids[i] = emps[i].id;
+        t.locs[i] = emps[i].pickup;
+        t.ready[i] = emps[i].ready_time;
+    }
+    t.end_node = (int)t.ids.size();
+    t.ids.push_back("END");
+    t.locs.push_back(OFFICE);
+    t.office_start_node = (int)t.ids.size();
+    t.ids.push_back("START");
+    t.locs.push_back(OFFICE);
+    for (auto& v : vehs) {
+        v.current_node = (int)t.ids.size();
+        t.ids.push_back("START");
+        t.locs.push_back(v.depot_loc);
+    }
+    g_nodes = std::move(t);
+    route_cache_clear();     // cached trips refer to the old node numbering
+}
+
+Stop pickup_stop(const Employee& emp) {
+    Stop s;
+    s.node = emp.index;
+    s.arrival_time = s.begin_service = s.departure_time = 0;
+    return s;
+}
+
+EmployeeIndex build_employee_index(const vector<Employee>& emps) {
+    EmployeeIndex idx;
+    idx.reserve(emps.size() * 2);
+    for (const auto& e : emps) idx.emplace(e.id, &e);
+    return idx;
+}
+
+bool check_compatibility(const Vehicle& v, const Employee& e, const Route& route,
+                         const uint64_t* trip_mask) {
+    if (!compat_eligible(v.category, e)) return false;
+    // "Can e share a trip with everyone already in it": one bit of the trip's
+    // AND row when the caller has it, else one bit per passenger.
+    if (trip_mask) {
+        if (e.index >= 0 && e.index < g_compat.n && !bit_test(trip_mask, e.index)) return false;
+    } else if (!compat_with_trip(route.stops, e)) {
+        return false;
+    }
+    // if (e.veh_pref == NORMAL && v.category == PREMIUM) return false;
+
+    int emp_limit = 100;
+    // if (e.share_pref == SINGLE) emp_limit = 1;
+    // else if (e.share_pref == DOUBLE) emp_limit = 2;
+    // else if (e.share_pref == TRIPLE) emp_limit = 3;
+
+    int effective_capacity = min(route.max_capacity, min((int)v.capacity, emp_limit));
+    // route.current_capacity is number of passengers already in this trip.
+    if (route.current_capacity + 1 > effective_capacity) return false;
+
+    return true;
+}
+
+// Empty trip of v leaving START node `start_node` at `time`.
+static Route trip_leaving(const Vehicle& v, int start_node, int time) {
+    Route r;
+
+    Stop start;
+    start.node = start_node;
+    start.arrival_time = start.begin_service = start.departure_time = time;
+    r.stops.push_back(start);
+
+    // Trip end sentinel: the common corporate office.
+    Stop end = start;
+    end.node = g_nodes.end_node;
+    r.stops.push_back(end);
+
+    r.current_capacity = 0;
+    r.max_capacity = (int)v.capacity;
+    r.hash = route_hash(r.stops);
+    r.total_distance = 0;
+    r.total_cost = 0;
+    return r;
+}
+
+Route make_empty_trip(const Vehicle& v) {
+    return trip_leaving(v, v.current_node, v.available_time);
+}
+
+Route make_next_trip(const Vehicle& v) {
+    const int time = v.routes.empty() ? v.available_time : v.routes.back().stops.back().departure_time;
+    return trip_leaving(v, g_nodes.office_start_node, time);
+}
+
+bool is_empty_trip(const Route& r) { return r.stops.size() <= 2; }
+
+Vehicle vehicle_before_trip(const Vehicle& v, size_t first) {
+    Vehicle out = v;
+    size_t prev = first;
+    while (prev > 0 && is_empty_trip(v.routes[prev - 1])) prev--;
+    if (prev > 0) {
+        out.current_node = g_nodes.office_start_node;
+        out.available_time = v.routes[prev - 1].stops.back().departure_time;
+    } else if (!v.routes.empty()) {
+        out.current_node = v.routes.front().stops.front().node;
+        out.available_time = v.routes.front().stops.front().departure_time;
+    }
+    out.routes.clear();
+    out.total_cost = 0.0;
+    return out;
+}
+
+vector<Vehicle> blank_fleet(const vector<Vehicle>& vehicles) {
+    vector<Vehicle> out = vehicles;
+    for (auto& v : out) {
+        if (!v.routes.empty()) {
+            const Stop& start = v.routes.front().stops.front();
+            v.current_node = start.node;
+            v.available_time = start.departure_time;
+        }
+        v.routes.clear();
+        v.routes.push_back(make_empty_trip(v));
+        v.total_cost = 0.0;
+    }
+    return out;
+}
+
+// Re-times stops [from, size) given correct times at from-1.
+static bool retime_from(StopList& stops, size_t from, double speed_kmh, const EmployeeIndex& idx) {
+    for (size_t i = from; i < stops.size(); i++) {
+        Stop& prev = stops[i - 1];
+        Stop& cur = stops[i];
+        int arrival = prev.departure_time + travel_minutes(get_dist(prev.loc(), cur.loc()), speed_kmh);
+        cur.arrival_time = arrival;
+
+        if (!cur.is_pickup()) {
+            // Office end: no service time.
+            cur.begin_service = arrival;
+            cur.departure_time = arrival;
+            continue;
+        }
+        auto it = idx.find(cur.emp_id());
+        if (it == idx.end()) return false;
+        // Respect earliest pickup (ready time): wait if early.
+        cur.begin_service = max(arrival, it->second->ready_time);
+        cur.departure_time = cur.begin_service + SERVICE_PICKUP_MIN;
+    }
+    return true;
+}
+
+bool finalize_route(Route& route, const Vehicle& v, const EmployeeIndex& idx) {
+    MemberList members;
+    double dist = 0.0;
+    route.max_edge_km = 0.0;
+    route.centroid = {0.0, 0.0};
+    route.leg_km.assign(route.stops.size(), 0.0);
+    for (size_t i = 0; i < route.stops.size(); i++) {
+        const Location& here = route.stops[i].loc();
+        route.centroid.lat += here.lat;
+        route.centroid.lng += here.lng;
+        if (i > 0) {
+            const double leg = get_dist(route.stops[i - 1].loc(), here);
+            route.leg_km[i] = leg;
+            dist += leg;
+            route.max_edge_km = max(route.max_edge_km, leg);
+        }
+        if (!route.stops[i].is_pickup()) continue;
+        auto it = idx.find(route.stops[i].emp_id());
+        if (it == idx.end()) return false;
+        members.push_back(it->second);
+    }
+
+    if (!route.stops.empty()) {
+        route.centroid.lat /= route.stops.size();
+        route.centroid.lng /= route.stops.size();
+    }
+    route.radius_km = 0.0;
+    for (const auto& s : route.stops) route.radius_km = max(route.radius_km, get_dist(route.centroid, s.loc()));
+
+    route.current_capacity = (int)members.size();
+    route.total_distance = dist;
+    route.total_cost = dist * v.cost_per_km;
+    route.removal_gain_stale = true;
+    route.hash = route_hash(route.stops);
+
+    // Soft latest drop: every passenger may be late up to its priority allowance.
+    update_lateness_profile(route.late, members);
+    const int office_arrival = route.stops.back().arrival_time;
+    anchor_lateness_profile(route.late, office_arrival);
+    route.lateness_penalty = profile_penalty(route.late, office_arrival);
+    route.late_minutes = profile_late_minutes(route.late, office_arrival);
+    refresh_route_times(route);
+    return office_arrival <= route.late.hard_deadline;
+}
+
+bool simulate_route(Route& route, const Vehicle& v, const EmployeeIndex& idx) {
+    if (route.stops.size() < 2) return false;
+    if (route.stops.back().node != g_nodes.end_node) return false;
+    if (route.stops.front().is_pickup()) return false;
+    for (size_t i = 1; i + 1 < route.stops.size(); i++)
+        if (!route.stops[i].is_pickup()) return false;
+
+    const uint64_t key = route_cache_key(route, v);
+    bool feasible = false;
+    if (route_cache_get(key, v, {route.stops}, route, feasible)) return feasible;
+
+    if (!retime_from(route.stops, 1, v.speed_kmh, idx)) return false;
+    feasible = finalize_route(route, v, idx);
+    route_cache_put(key, v, route, feasible);
+    return feasible;
+}
+
+static bool insertion_position_ok(const Route& route, int insert_before_idx, string& fail_reason) {
+    if (route.stops.empty()) {
+        fail_reason = "route has no start";
+        return false;
+    }
+    // Valid insert positions are between START and END (i.e., [1, size-1]);
+    // inserting before END means insert_before_idx == route.stops.size() - 1.
+    if (insert_before_idx < 1 || insert_before_idx > (int)route.stops.size() - 1) {
+        fail_reason = "invalid insertion position";
+        return false;
+    }
+    if (route.stops.back().node != g_nodes.end_node) {
+        fail_reason = "route missing END sentinel";
+        return false;
+    }
+    return true;
+}
+
+// Route-cache key of `route` with emp's pickup inserted before insert_before_idx:
+// the hash swaps the split leg for the two new ones (zobrist.h).
+static uint64_t insertion_cache_key(const Route& route, const Employee& emp, int insert_before_idx,
+                                    double speed_kmh) {
+    const int a = route.stops[insert_before_idx - 1].node;
+    const int b = route.stops[insert_before_idx].node;
+    const uint64_t h = route.hash ? route.hash : route_hash(route.stops);
+    return route_cache_key(h ^ leg_key(a, b) ^ leg_key(a, emp.index) ^ leg_key(emp.index, b),
+                           route.stops[0].departure_time, speed_kmh);
+}
+
+// route.late holds the tightest deadline of the existing passengers,
+// so only the new one has to be checked individually.
+static bool insertion_deadline_ok(const Route& route, const Employee& emp, int office_arrival,
+                                  string& fail_reason) {
+    if (office_arrival > hard_due(emp)) {
+        fail_reason = "latest_drop violated for ";   // appended so a reused string keeps its buffer
+        fail_reason += emp.id;
+        return false;
+    }
+    if (office_arrival > route.late.hard_deadline) {
+        fail_reason = "latest_drop violated for a passenger already in the trip";
+        return false;
+    }
+    return true;
+}
+
+static bool retime_insertion(const Route& route, const Employee& emp, int insert_before_idx,
+                             double speed_kmh, const EmployeeIndex& idx,
+                             StopList& out_stops, string& fail_reason) {
+    out_stops.clear();
+    out_stops.reserve(route.stops.size() + 1);
+    out_stops.insert(out_stops.end(), route.stops.begin(), route.stops.begin() + insert_before_idx);
+
+    out_stops.push_back(pickup_stop(emp));
+
+    out_stops.insert(out_stops.end(), route.stops.begin() + insert_before_idx, route.stops.end());
+
+    if (!retime_from(out_stops, (size_t)insert_before_idx, speed_kmh, idx)) {
+        fail_reason = "unknown employee in route";
+        return false;
+    }
+    return true;
+}
+
+bool simulate_insertion(const Route& route, const Employee& emp, int insert_before_idx,
+                        double speed_kmh, const EmployeeIndex& idx,
+                        StopList& out_stops, string& fail_reason) {
+    if (!insertion_position_ok(route, insert_before_idx, fail_reason)) return false;
+    const uint64_t key = insertion_cache_key(route, emp, insert_before_idx, speed_kmh);
+    if (!route_cache_get_stops(key, speed_kmh, {route.stops, emp.index, insert_before_idx}, out_stops) &&
+        !retime_insertion(route, emp, insert_before_idx, speed_kmh, idx, out_stops, fail_reason))
+        return false;
+    return insertion_deadline_ok(route, emp, out_stops.back().arrival_time, fail_reason);
+}
+
+bool insert_pickup(const Route& route, const Employee& emp, int insert_before_idx,
+                   const Vehicle& v, const EmployeeIndex& idx, Route& out, string& fail_reason) {
+    if (!insertion_position_ok(route, insert_before_idx, fail_reason)) return false;
+    const uint64_t key = insertion_cache_key(route, emp, insert_before_idx, v.speed_kmh);
+    bool feasible = false;
+    if (route_cache_get(key, v, {route.stops, emp.index, insert_before_idx}, out, feasible))
+        return insertion_deadline_ok(route, emp, out.stops.back().arrival_time, fail_reason) && feasible;
+
+    if (!retime_insertion(route, emp, insert_before_idx, v.speed_kmh, idx, out.stops, fail_reason)) return false;
+    if (!insertion_deadline_ok(route, emp, out.stops.back().arrival_time, fail_reason)) return false;
+    feasible = finalize_route(out, v, idx);
+    route_cache_put(key, v, out, feasible);
+    return feasible;
+}
+
+bool chain_has_slack(const Vehicle& v, size_t r, int end_time) {
+    if (r + 1 >= v.routes.size()) return true;
+    return end_time <= v.routes[r + 1].stops.front().departure_time;
+}
+
+bool rechain_trips(Vehicle& v, size_t changed, const EmployeeIndex& idx) {
+    for (size_t t = changed + 1; t < v.routes.size(); t++) {
+        const int ready = v.routes[t - 1].stops.back().departure_time;
+        Stop& start = v.routes[t].stops.front();
+        if (start.departure_time >= ready) break;   // this and later trips are unaffected
+        start.arrival_time = start.begin_service = start.departure_time = ready;
+        if (!simulate_route(v.routes[t], v, idx)) return false;
+    }
+    if (!v.routes.empty()) {
+        v.available_time = v.routes.back().stops.back().departure_time;
+        v.current_node = g_nodes.office_start_node;   // every trip ends at the office
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+#include "spatial_index.h"
+#include <algorithm>
+#include <cmath>
+#include "geo.h"
+#include "config.h"
+
+using namespace std;
+
+void SpatialGrid::build(const vector<Location>& points, int per_cell) {
+    pts = points;
+    cells.clear();
+    rows = cols = 0;
+    if (pts.empty()) return;
+
+    double lat1 = pts[0].lat, lng1 = pts[0].lng;
+    lat0 = lat1; lng0 = lng1;
+    for (const auto& p : pts) {
+        lat0 = min(lat0, p.lat); lat1 = max(lat1, p.lat);
+        lng0 = min(lng0, p.lng); lng1 = max(lng1, p.lng);
+    }
+
+    // Square cells sized so the bounding box holds ~n/per_cell of them.
+    const double span_lat = max(lat1 - lat0, 1e-6);
+    const double span_lng = max(lng1 - lng0, 1e-6);
+    const double n_cells = max(1.0, (double)pts.size() / max(1, per_cell));
+    cell_deg = sqrt(span_lat * span_lng / n_cells);
+    rows = (int)(span_lat / cell_deg) + 1;
+    cols = (int)(span_lng / cell_deg) + 1;
+    cells.assign((size_t)rows * cols, {});
+
+    for (int i = 0; i < (int)pts.size(); i++) {
+        cells[(size_t)cell_row(pts[i].lat) * cols + cell_col(pts[i].lng)].push_back(i);
+    }
+}
+
+int SpatialGrid::cell_row(double lat) const {
+    return min(rows - 1, max(0, (int)((lat - lat0) / cell_deg)));
+}
+
+int SpatialGrid::cell_col(double lng) const {
+    return min(cols - 1, max(0, (int)((lng - lng0) / cell_deg)));
+}
+
+std::pmr::vector<int> SpatialGrid::nearest(const Location& at, int k, std::pmr::memory_resource* mr) const {
+    std::pmr::vector<pair<double,int>> found(mr);
+    std::pmr::vector<int> out(mr);
+    if (rows == 0 || k <= 0) return out;
+    k = min(k, (int)pts.size());
+
+    // Lower bound (km) on the distance to anything outside ring r: the ring's
+    // inner edge, measured along a meridian so it never overestimates.
+    const double km_per_deg = get_dist({0.0, 0.0}, {1.0, 0.0});
+    const int r0 = cell_row(at.lat), c0 = cell_col(at.lng);
+    const int max_ring = max(rows, cols);
+
+    for (int ring = 0; ring <= max_ring; ring++) {
+        for (int r = r0 - ring; r <= r0 + ring; r++) {
+            if (r < 0 || r >= rows) continue;
+            const bool edge_row = (r == r0 - ring || r == r0 + ring);
+            for (int c = c0 - ring; c <= c0 + ring; c += (edge_row ? 1 : 2 * max(ring, 1))) {
+                if (c < 0 || c >= cols) continue;
+                for (int i : cells[(size_t)r * cols + c]) found.push_back({get_dist(at, pts[i]), i});
+            }
+        }
+        if ((int)found.size() >= k) {
+            nth_element(found.begin(), found.begin() + (k - 1), found.end());
+            const double kth = found[k - 1].first;
+            // Longitude degrees shrink with latitude; scale the bound conservatively.
+            const double bound = ring * cell_deg * km_per_deg * cos(min(89.0, fabs(at.lat) + ring * cell_deg) * PI / 180.0);
+            if (kth <= bound) break;
+        }
+    }
+
+    sort(found.begin(), found.end());
+    for (int i = 0; i < (int)found.size() && (int)out.size() < k; i++) out.push_back(found[i].second);
+    return out;
+}
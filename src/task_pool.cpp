@@ -0,0 +1,143 @@
+#include "task_pool.h"
+#include <algorithm>
+#include "alloc_counter.h"
+
+static thread_local bool t_in_pool = false;      // inside a parallel_for on this thread
+
+static inline uint64_t pack(int begin, int end) { return ((uint64_t)(uint32_t)begin << 32) | (uint32_t)end; }
+static inline int range_begin(uint64_t r) { return (int)(r >> 32); }
+static inline int range_end(uint64_t r) { return (int)(uint32_t)r; }
+
+TaskPool::TaskPool(int threads)
+    : threads_(std::max(1, threads)), ranges_(new std::atomic<uint64_t>[std::max(1, threads)]) {
+    for (int t = 0; t < threads_; t++) ranges_[t].store(0);
+    for (int t = 1; t < threads_; t++) workers_.emplace_back(&TaskPool::worker_main, this, t);
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& th : workers_) th.join();
+}
+
+// Next chunk for participant `self`: from the front of its own range, else the
+// back half of another participant's range, which becomes its own.
+bool TaskPool::take(int self, int& begin, int& end) {
+    std::atomic<uint64_t>& mine = ranges_[self];
+    uint64_t r = mine.load();
+    while (range_begin(r) < range_end(r)) {
+        const int b = range_begin(r);
+        const int e = std::min(range_end(r), b + grain_);
+        if (mine.compare_exchange_weak(r, pack(e, range_end(r)))) {
+            begin = b;
+            end = e;
+            return true;
+        }
+    }
+    for (int k = 1; k < threads_; k++) {
+        std::atomic<uint64_t>& other = ranges_[(self + k) % threads_];
+        uint64_t o = other.load();
+        while (range_end(o) - range_begin(o) > 0) {
+            const int b = range_begin(o), e = range_end(o);
+            const int mid = b + (e - b) / 2;
+            if (other.compare_exchange_weak(o, pack(b, mid))) {
+                // Run the first chunk now, leave the rest stealable.
+                const int first = std::min(e, mid + grain_);
+                mine.store(pack(first, e));
+                begin = mid;
+                end = first;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void TaskPool::work(int self) {
+    int begin, end;
+    while (take(self, begin, end)) {
+        for (int i = begin; i < end; i++) call_(ctx_, i);
+        pending_.fetch_sub(end - begin);
+    }
+}
+
+void TaskPool::worker_main(int self) {
+    t_in_pool = true;
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            cv_.wait(lk, [&] { return stop_ || (open_ && generation_ != seen); });
+            if (stop_) return;
+            seen = generation_;
+            active_++;
+        }
+        const uint64_t before = heap_allocations();
+        work(self);
+        allocs_.fetch_add(heap_allocations() - before, std::memory_order_relaxed);
+        active_--;
+    }
+}
+
+void TaskPool::run(int n, int grain, Call call, void* ctx) {
+    grain = std::max(1, grain);
+    bool idle = false;
+    if (n <= grain || threads_ == 1 || t_in_pool || !busy_.compare_exchange_strong(idle, true)) {
+        for (int i = 0; i < n; i++) call(ctx, i);
+        return;
+    }
+    t_in_pool = true;
+
+    const int parts = std::min(threads_, (n + grain - 1) / grain);
+    for (int t = 0; t < threads_; t++) {
+        const int b = t < parts ? (int)((int64_t)n * t / parts) : n;
+        const int e = t < parts ? (int)((int64_t)n * (t + 1) / parts) : n;
+        ranges_[t].store(pack(b, e));
+    }
+    pending_.store(n);
+    allocs_.store(0, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        call_ = call;
+        ctx_ = ctx;
+        grain_ = grain;
+        generation_++;
+        open_ = true;
+    }
+    cv_.notify_all();
+
+    work(0);
+    while (pending_.load() > 0) std::this_thread::yield();
+    {
+        // Late wakers must not join a finished job; the ones inside leave promptly.
+        std::lock_guard<std::mutex> lk(m_);
+        open_ = false;
+    }
+    while (active_.load() > 0) std::this_thread::yield();
+    credit_heap_allocations(allocs_.load(std::memory_order_relaxed));
+
+    t_in_pool = false;
+    busy_.store(false);
+}
+
+static int g_threads = 0;
+static std::unique_ptr<TaskPool> g_pool;
+static std::mutex g_pool_mutex;
+
+void task_pool_configure(int threads) {
+    std::lock_guard<std::mutex> lk(g_pool_mutex);
+    g_threads = threads;
+    g_pool.reset();
+}
+
+TaskPool& task_pool() {
+    std::lock_guard<std::mutex> lk(g_pool_mutex);
+    if (!g_pool) {
+        const int t = g_threads > 0 ? g_threads : (int)std::thread::hardware_concurrency();
+        g_pool.reset(new TaskPool(std::max(1, t)));
+    }
+    return *g_pool;
+}
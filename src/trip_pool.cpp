@@ -0,0 +1,362 @@
+#include "trip_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include "alns_operators.h"
+#include "config.h"
+#include "geo.h"
+#include "lateness.h"
+#include "local_search.h"
+#include "objective.h"
+#include "spatial_index.h"
+#include "zobrist.h"
+
+using namespace std;
+
+// ------------------------------------------------------------
+// Pool bookkeeping
+// ------------------------------------------------------------
+void TripPool::init(const vector<Employee>& instance, const vector<Vehicle>& vehicles) {
+    instance_ = &instance;
+    pos_.clear();
+    for (int i = 0; i < (int)instance.size(); i++) pos_[instance[i].id] = i;
+
+    types_.clear();
+    for (const auto& v : vehicles) {
+        const int t = type_of(v);
+        if (t >= 0) {
+            types_[t].min_cost_per_km = min(types_[t].min_cost_per_km, v.cost_per_km);
+            continue;
+        }
+        types_.push_back({v.category, (int)v.capacity, v.speed_kmh, v.cost_per_km});
+    }
+    trips_.clear();
+    by_key_.clear();
+}
+
+int TripPool::type_of(const Vehicle& v) const {
+    for (int t = 0; t < (int)types_.size(); t++) {
+        const TripType& tt = types_[t];
+        if (tt.category == v.category && tt.capacity == (int)v.capacity && tt.speed_kmh == v.speed_kmh) return t;
+    }
+    return -1;
+}
+
+bool TripPool::add(int type, const vector<int>& order, double dist_km) {
+    vector<int> members = order;
+    sort(members.begin(), members.end());
+    string key = to_string(type);
+    for (int i : members) key += ":" + to_string(i);
+
+    auto it = by_key_.find(key);
+    if (it != by_key_.end()) {
+        PoolTrip& known = trips_[it->second];
+        if (dist_km < known.dist_km) { known.order = order; known.dist_km = dist_km; }
+        return false;
+    }
+    by_key_.emplace(std::move(key), (int)trips_.size());
+    trips_.push_back({type, std::move(members), order, dist_km});
+    return true;
+}
+
+void TripPool::add_route(const Route& r, const Vehicle& v) {
+    if (r.stops.size() <= 2) return;
+    const int t = type_of(v);
+    if (t < 0) return;
+
+    vector<int> order;
+    double dist = 0.0;
+    for (size_t i = 1; i < r.stops.size(); i++) {
+        if (i > 1) dist += get_dist(r.stops[i - 1].loc(), r.stops[i].loc());   // skip the START leg
+        if (r.stops[i].is_pickup()) order.push_back(pos_.at(r.stops[i].emp_id()));
+    }
+    add(t, order, dist);
+}
+
+// ------------------------------------------------------------
+// Pickup-order DP
+// ------------------------------------------------------------
+bool best_pickup_order(const vector<Employee>& instance, const vector<int>& members,
+                       double speed_kmh, vector<int>& order, double& dist_km) {
+    const int k = (int)members.size();
+    if (k == 0 || k > 12) return false;
+
+    int deadline = INT_MAX;
+    for (int i : members) deadline = min(deadline, hard_due(instance[i]));
+
+    // Two labels per (set, last): shortest distance and earliest departure;
+    // neither dominates the other once waiting for ready times is involved.
+    struct Label { double dist = INF; int dep = INT_MAX; int prev = -1; int prev_label = 0; };
+    const int full = (1 << k) - 1;
+    vector<Label> lab((size_t)(full + 1) * k * 2);
+    auto at = [&](int mask, int last, int l) -> Label& { return lab[((size_t)mask * k + last) * 2 + l]; };
+    auto office_min = [&](int j) { return travel_minutes(get_dist(instance[members[j]].pickup, OFFICE), speed_kmh); };
+
+    auto offer = [&](int mask, int j, double dist, int dep, int prev, int prev_label) {
+        if (dep + office_min(j) > deadline) return;
+        Label& by_dist = at(mask, j, 0);
+        if (dist < by_dist.dist || (dist == by_dist.dist && dep < by_dist.dep)) by_dist = {dist, dep, prev, prev_label};
+        Label& by_time = at(mask, j, 1);
+        if (dep < by_time.dep || (dep == by_time.dep && dist < by_time.dist)) by_time = {dist, dep, prev, prev_label};
+    };
+
+    for (int j = 0; j < k; j++) {
+        const Employee& e = instance[members[j]];
+        offer(1 << j, j, 0.0, e.ready_time + SERVICE_PICKUP_MIN, -1, 0);
+    }
+
+    for (int mask = 1; mask <= full; mask++) {
+        for (int last = 0; last < k; last++) {
+            if (!(mask & (1 << last))) continue;
+            for (int l = 0; l < 2; l++) {
+                const Label& cur = at(mask, last, l);
+                if (cur.dep == INT_MAX) continue;
+                const Location& from = instance[members[last]].pickup;
+                for (int j = 0; j < k; j++) {
+                    if (mask & (1 << j)) continue;
+                    const Employee& e = instance[members[j]];
+                    const double d = get_dist(from, e.pickup);
+                    const int begin = max(cur.dep + travel_minutes(d, speed_kmh), e.ready_time);
+                    offer(mask | (1 << j), j, cur.dist + d, begin + SERVICE_PICKUP_MIN, last, l);
+                }
+            }
+        }
+    }
+
+    int best_last = -1, best_l = 0;
+    double best = INF;
+    for (int last = 0; last < k; last++) {
+        for (int l = 0; l < 2; l++) {
+            const Label& cur = at(full, last, l);
+            if (cur.dep == INT_MAX) continue;
+            const double total = cur.dist + get_dist(instance[members[last]].pickup, OFFICE);
+            if (total < best) { best = total; best_last = last; best_l = l; }
+        }
+    }
+    if (best_last < 0) return false;
+
+    order.assign(k, -1);
+    int mask = full, last = best_last, l = best_l;
+    for (int p = k - 1; p >= 0; p--) {
+        order[p] = members[last];
+        const Label& cur = at(mask, last, l);
+        mask &= ~(1 << last);
+        l = cur.prev_label;
+        last = cur.prev;
+    }
+    dist_km = best;
+    return true;
+}
+
+// ------------------------------------------------------------
+// Enumeration
+// ------------------------------------------------------------
+size_t enumerate_trips(TripPool& pool, const TripPoolConfig& cfg) {
+    const vector<Employee>& inst = pool.instance();
+    const int n = (int)inst.size();
+    vector<Location> pts;
+    for (const auto& e : inst) pts.push_back(e.pickup);
+    SpatialGrid grid;
+    grid.build(pts);
+
+    size_t added = 0;
+    vector<int> order;
+    double dist;
+
+    for (int t = 0; t < (int)pool.types().size(); t++) {
+        const TripType tt = pool.types()[t];
+        const int cap = min(cfg.max_set_size, tt.capacity);
+        if (cap <= 0) continue;
+        auto eligible = [&](int i) { return inst[i].veh_pref != PREMIUM || tt.category == PREMIUM; };
+
+        // Compatible neighbours: nearest pickups that can share at least a 2-person trip.
+        vector<vector<int>> adj(n);
+        for (int i = 0; i < n; i++) {
+            if (!eligible(i)) continue;
+            if (best_pickup_order(inst, {i}, tt.speed_kmh, order, dist) && pool.add(t, order, dist)) added++;
+            if (cap < 2) continue;
+            int found = 0;
+            for (int j : grid.nearest(inst[i].pickup, 4 * cfg.neighbours + 1)) {
+                if (found >= cfg.neighbours) break;
+                if (j == i || !eligible(j)) continue;
+                if (!best_pickup_order(inst, {i, j}, tt.speed_kmh, order, dist)) continue;
+                adj[i].push_back(j);
+                adj[j].push_back(i);
+                found++;
+            }
+        }
+        for (auto& a : adj) { sort(a.begin(), a.end()); a.erase(unique(a.begin(), a.end()), a.end()); }
+
+        // Grow sets in increasing index order through common neighbours. A set that
+        // misses its deadlines stays infeasible with more passengers, so it is not grown.
+        vector<int> set;
+        auto grow = [&](auto&& self, const vector<int>& cand) -> void {
+            for (size_t c = 0; c < cand.size(); c++) {
+                if (pool.trips().size() >= cfg.max_trips) return;
+                set.push_back(cand[c]);
+                if (set.size() >= 2 && best_pickup_order(inst, set, tt.speed_kmh, order, dist)) {
+                    if (pool.add(t, order, dist)) added++;
+                    if ((int)set.size() < cap) {
+                        vector<int> next;
+                        const auto& a = adj[cand[c]];
+                        for (size_t d = c + 1; d < cand.size(); d++)
+                            if (binary_search(a.begin(), a.end(), cand[d])) next.push_back(cand[d]);
+                        self(self, next);
+                    }
+                }
+                set.pop_back();
+            }
+        };
+        for (int i = 0; i < n && pool.trips().size() < cfg.max_trips; i++) {
+            if (adj[i].empty()) continue;
+            vector<int> cand;
+            for (int j : adj[i]) if (j > i) cand.push_back(j);
+            set = {i};
+            grow(grow, cand);
+        }
+    }
+    return added;
+}
+
+// ------------------------------------------------------------
+// Set-partitioning recombination
+// ------------------------------------------------------------
+// Builds pool trip `pt` as the next trip of v; false if v cannot run it.
+static bool place_trip(const PoolTrip& pt, const Vehicle& v, const vector<Employee>& inst,
+                       const EmployeeIndex& idx, Route& out) {
+    out = v.routes.back().stops.size() <= 2 ? v.routes.back() : make_next_trip(v);
+    Route probe = out;
+    probe.current_capacity = (int)pt.order.size() - 1;
+    for (int i : pt.order)
+        if (!check_compatibility(v, inst[i], probe)) return false;
+
+    for (int i : pt.order) {
+        out.stops.insert(out.stops.end() - 1, pickup_stop(inst[i]));
+    }
+    return simulate_route(out, v, idx);
+}
+
+struct Recombined {
+    SolutionState state;
+    vector<Vehicle> vehs;
+    SolutionObjective obj;
+    double score = numeric_limits<double>::infinity();   // INF is below the unrouted penalty
+};
+
+static Recombined select_and_assign(const TripPool& pool, const vector<Employee>& employees,
+                                    const vector<Vehicle>& blank, const EmployeeIndex& idx,
+                                    const ObjectiveWeights& w, double noise, mt19937& rng) {
+    const vector<Employee>& inst = pool.instance();
+    const auto& trips = pool.trips();
+    uniform_real_distribution<double> U(-1.0, 1.0);
+
+    // Rank by estimated cost per passenger; noise diversifies later rounds.
+    vector<pair<double,int>> rank;
+    rank.reserve(trips.size());
+    for (int k = 0; k < (int)trips.size(); k++) {
+        const PoolTrip& pt = trips[k];
+        double key = pt.dist_km * pool.types()[pt.type].min_cost_per_km / pt.members.size();
+        if (noise > 0.0) key *= 1.0 + noise * U(rng);
+        rank.push_back({key, k});
+    }
+    sort(rank.begin(), rank.end());
+
+    vector<char> covered(inst.size(), 0);
+    vector<int> chosen;
+    for (const auto& rk : rank) {
+        const PoolTrip& pt = trips[rk.second];
+        bool clash = false;
+        for (int i : pt.members) if (covered[i]) { clash = true; break; }
+        if (clash) continue;
+        for (int i : pt.members) covered[i] = 1;
+        chosen.push_back(rk.second);
+    }
+    // Chronological assignment keeps each vehicle's trips appended in time order.
+    sort(chosen.begin(), chosen.end(), [&](int a, int b) {
+        return inst[trips[a].order.front()].ready_time < inst[trips[b].order.front()].ready_time;
+    });
+
+    Recombined out;
+    out.vehs = blank;
+    out.state.routed.assign(employee_index_space(employees), 0);
+    out.state.at.assign(out.state.routed.size(), Placement());
+    out.obj.unrouted = (int)employees.size();
+
+    Route cand, best;
+    for (int k : chosen) {
+        const PoolTrip& pt = trips[k];
+        int best_v = -1;
+        double best_c = INF;
+        for (int vi = 0; vi < (int)out.vehs.size(); vi++) {
+            if (!place_trip(pt, out.vehs[vi], inst, idx, cand)) continue;
+            const double c = route_score(cand, w);
+            if (c < best_c) { best_c = c; best_v = vi; best = cand; }
+        }
+        if (best_v < 0) continue;     // left to the insertion repair
+
+        Vehicle& v = out.vehs[best_v];
+        if (v.routes.back().stops.size() > 2) v.routes.emplace_back();
+        v.routes.back() = std::move(best);
+        rechain_trips(v, v.routes.size() - 1, idx);
+        v.total_cost = vehicle_cost(v);
+        out.obj.add(route_objective(v.routes.back()));
+        out.state.place_trip(v.routes.back(), best_v, (int)v.routes.size() - 1);
+        for (int i : pt.members) out.state.routed[i] = 1;
+        out.obj.unrouted -= (int)pt.members.size();
+    }
+
+    out.obj.hash = solution_hash(out.vehs);     // the insertions below keep it
+    vector<int> missing;
+    for (int i = 0; i < (int)inst.size(); i++) if (!out.state.routed[i]) missing.push_back(i);
+    sort(missing.begin(), missing.end(), [&](int a, int b){ return inst[a].due_time < inst[b].due_time; });
+    for (int i : missing) try_insert_anywhere(out.state, out.vehs, inst[i], idx, w, out.obj);
+
+    out.score = out.obj.score(w);
+    return out;
+}
+
+void solve_trip_pool(vector<Employee>& employees, vector<Vehicle>& vehicles,
+                     const ALNSConfig& alns_cfg, const TripPoolConfig& cfg, bool debug) {
+    const vector<Employee> instance = employees;
+    const EmployeeIndex idx = build_employee_index(instance);
+    const ObjectiveWeights w = objective_weights_from_instance();
+    const vector<Vehicle> blank = blank_fleet(vehicles);
+
+    TripPool pool;
+    pool.init(instance, vehicles);
+    run_alns(employees, vehicles, alns_cfg, debug, &pool);
+    for (const auto& v : vehicles)
+        for (const auto& r : v.routes) pool.add_route(r, v);
+    const size_t from_alns = pool.trips().size();
+    const size_t enumerated = enumerate_trips(pool, cfg);
+
+    cout << "--- Trip Pool Recombination ---\n" << endl;
+    cout << "  Pool: " << pool.trips().size() << " trips (" << from_alns << " from ALNS, "
+         << enumerated << " enumerated)" << endl;
+
+    mt19937 rng((unsigned)random_device{}());
+    Recombined best;
+    for (int round = 0; round < cfg.rounds; round++) {
+        Recombined r = select_and_assign(pool, employees, blank, idx, w, round == 0 ? 0.0 : cfg.noise, rng);
+        if (debug) cout << "[POOL] round " << round << " score=" << fixed << setprecision(2) << r.score << endl;
+        if (r.score < best.score) best = std::move(r);
+    }
+    relocate_local_search(best.vehs, idx, w, best.obj, rng, cfg.ls_passes);
+    resequence_trips(best.vehs, idx, w, best.obj, true);
+    best.score = best.obj.score(w);
+
+    const double alns_score = evaluate_solution(employees, vehicles).score(w);
+    cout << "  ALNS " << fixed << setprecision(2) << alns_score << " vs recombined " << best.score;
+    if (best.score < alns_score - 1e-9) {
+        cout << "  -> recombined kept\n" << endl;
+        store_routed_flags(best.state, employees);
+        for (const auto& e : employees)
+            if (e.is_routed) g_unrouted_reason.erase(e.id);
+        vehicles = std::move(best.vehs);
+    } else {
+        cout << "  -> ALNS kept\n" << endl;
+    }
+}
@@ -0,0 +1,120 @@
+#include "warm_start.h"
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include "alns_operators.h"
+#include "config.h"
+#include "file_utils.h"
+#include "heuristic.h"
+#include "mini_json.h"
+#include "objective.h"
+#include "route_eval.h"
+#include "time_utils.h"
+
+using namespace std;
+using Json = mini_json::Value;
+
+// Appends `e` as the last pickup of `r`; false (r unchanged) if it does not fit.
+static bool append_passenger(Route& r, const Vehicle& v, const Employee& e, const EmployeeIndex& idx) {
+    if (!check_compatibility(v, e, r)) return false;
+    string why;
+    Route next = r;
+    if (!insert_pickup(r, e, (int)r.stops.size() - 1, v, idx, next, why)) return false;
+    r = std::move(next);
+    return true;
+}
+
+bool warm_start_from_output(const string& plan_file, vector<Employee>& employees,
+                            vector<Vehicle>& vehicles, WarmStartStats& stats, bool debug) {
+    Json plan;
+    try {
+        plan = mini_json::parse(read_file_to_string(plan_file));
+    } catch (const exception& ex) {
+        cerr << "ERROR: Cannot read warm-start plan " << plan_file << ": " << ex.what() << endl;
+        return false;
+    }
+    if (!plan["vehicles"].is_array()) {
+        cerr << "ERROR: Warm-start plan has no \"vehicles\" array: " << plan_file << endl;
+        return false;
+    }
+
+    const EmployeeIndex idx = build_employee_index(employees);
+    map<string, int> veh_pos;
+    for (int i = 0; i < (int)vehicles.size(); i++) veh_pos[vehicles[i].id] = i;
+    for (auto& v : vehicles) if (v.available_time == 0) v.available_time = parse_time("08:00");
+
+    // Rebuild the previous trips in order, re-timed for today's roster.
+    stats = WarmStartStats();
+    vector<char> placed(vehicles.size(), 0);
+    for (const auto& pv : plan["vehicles"].arr) {
+        auto vit = veh_pos.find(pv["vehicle_id"].as_string());
+        if (vit == veh_pos.end() || placed[vit->second]) continue;
+        Vehicle& v = vehicles[vit->second];
+        placed[vit->second] = 1;
+
+        for (const auto& trip : pv["trips"].arr) {
+            Route r = v.routes.empty() ? make_empty_trip(v) : make_next_trip(v);
+            // Leave no earlier than the plan did: departing early only turns into waiting.
+            const string planned_start = trip["start_time"].as_string();
+            if (!planned_start.empty()) {
+                Stop& start = r.stops.front();
+                const int t = max(start.departure_time, parse_time(planned_start));
+                start.arrival_time = start.begin_service = start.departure_time = t;
+                simulate_route(r, v, idx);
+            }
+            for (const auto& stop : trip["route"].arr) {
+                auto eit = idx.find(stop.as_string());
+                if (eit == idx.end()) {
+                    const string id = stop.as_string();
+                    if (id != "START" && id != "END") stats.departed++;
+                    continue;
+                }
+                Employee& e = employees[eit->second - employees.data()];
+                if (e.is_routed) continue;
+                if (append_passenger(r, v, e, idx)) { e.is_routed = true; stats.kept++; }
+                else stats.dropped++;
+            }
+            // Trips that were empty in the plan (a vehicle repositioning to the
+            // office) are kept; trips emptied by departures are not.
+            if (r.stops.size() > 2 || trip["route"].arr.size() <= 2) v.routes.push_back(std::move(r));
+        }
+    }
+    for (auto& v : vehicles) {
+        if (v.routes.empty()) {
+            Route r = make_empty_trip(v);
+            simulate_route(r, v, idx);
+            v.routes.push_back(std::move(r));
+        } else {
+            v.available_time = v.routes.back().stops.back().departure_time;
+            v.current_node = g_nodes.office_start_node;
+        }
+        v.total_cost = vehicle_cost(v);
+    }
+
+    // Everyone still unplaced (new employees, dropped passengers), tightest first.
+    const ObjectiveWeights w = objective_weights_from_instance();
+    SolutionState state = build_solution_state(employees, vehicles);
+    SolutionObjective obj = evaluate_solution(employees, vehicles);
+    for (int i : get_sorted_indices_by_tightness(employees)) {
+        const Employee& e = employees[i];
+        if (state.routed[e.index]) continue;
+        if (try_insert_anywhere(state, vehicles, e, idx, w, obj)) {
+            stats.inserted++;
+            g_unrouted_reason.erase(e.id);
+        } else {
+            g_unrouted_reason[e.id] = "No feasible insertion into the warm-start plan";
+        }
+    }
+    store_routed_flags(state, employees);
+    for (auto& v : vehicles) v.total_cost = vehicle_cost(v);
+
+    cout << "--- Warm Start from " << plan_file << " ---\n";
+    cout << "  Kept " << stats.kept << " passengers in their trips, " << stats.departed
+         << " departed, " << stats.dropped << " no longer fit, " << stats.inserted << " inserted; score "
+         << fixed << setprecision(2) << obj.score(w) << "\n" << endl;
+    if (debug) {
+        for (const auto& e : employees)
+            if (!e.is_routed) cout << "[WARM] unrouted " << e.id << endl;
+    }
+    return true;
+}
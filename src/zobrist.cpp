@@ -0,0 +1,62 @@
+#include "zobrist.h"
+
+// splitmix64 finalizer: a fixed bijective mix, so keys need no table and no seeding.
+static inline uint64_t mix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+uint64_t leg_key(int from, int to) {
+    return mix64(((uint64_t)(uint32_t)from << 32) | (uint32_t)to);
+}
+
+uint64_t route_hash(const StopList& stops) {
+    uint64_t h = 0;
+    for (size_t i = 1; i < stops.size(); i++) h ^= leg_key(stops[i - 1].node, stops[i].node);
+    return h;
+}
+
+uint64_t trip_key(const Route& r, size_t vi, size_t ri) {
+    const uint64_t salt = mix64(((uint64_t)vi << 32) ^ (0x5a17ull + ri));
+    return mix64(r.hash ^ salt);
+}
+
+uint64_t solution_hash(const std::vector<Vehicle>& vehicles) {
+    uint64_t h = 0;
+    for (size_t vi = 0; vi < vehicles.size(); vi++)
+        for (size_t ri = 0; ri < vehicles[vi].routes.size(); ri++)
+            h ^= trip_key(vehicles[vi].routes[ri], vi, ri);
+    return h;
+}
+
+FingerprintSet::FingerprintSet(size_t capacity) {
+    size_t sets = 1;
+    while (sets * WAYS < capacity) sets <<= 1;
+    slots_.assign(sets * WAYS, 0);
+    next_.assign(sets, 0);
+    sets_mask_ = sets - 1;
+}
+
+bool FingerprintSet::contains(uint64_t h) const {
+    if (h == 0) h = 1;
+    const uint64_t* set = &slots_[(h & sets_mask_) * WAYS];
+    for (size_t w = 0; w < WAYS; w++)
+        if (set[w] == h) return true;
+    return false;
+}
+
+bool FingerprintSet::insert(uint64_t h) {
+    if (h == 0) h = 1;
+    if (contains(h)) return false;
+    const size_t s = h & sets_mask_;
+    uint64_t* set = &slots_[s * WAYS];
+    for (size_t w = 0; w < WAYS; w++) {
+        if (set[w] == 0) { set[w] = h; inserted_++; return true; }
+    }
+    set[next_[s]] = h;
+    next_[s] = (uint8_t)((next_[s] + 1) % WAYS);
+    inserted_++;
+    return true;
+}